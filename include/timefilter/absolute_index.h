@@ -0,0 +1,330 @@
+/*
+ * absolute_index.h
+ *
+ * Author: Lain Musgrove (lain.proliant@gmail.com)
+ * Date: Sunday October 18, 2026
+ */
+
+#ifndef __TIMEFILTER_ABSOLUTE_INDEX_H
+#define __TIMEFILTER_ABSOLUTE_INDEX_H
+
+#include "timefilter/date.h"
+#include "timefilter/datetime.h"
+#include "timefilter/filter.h"
+#include "timefilter/static_range.h"
+#include "timefilter/year.h"
+
+namespace timefilter {
+
+// --------------------------------------------------------
+// The absolute filters of a list, such as a long list of
+// holidays or blackout ranges, kept sorted by start so that
+// the next and previous ranges are found by binary search
+// rather than by asking every filter.
+//
+// Dates and years start at midnight in whichever zone they
+// are evaluated in, while datetimes and static ranges are
+// fixed instants, so each kind is kept in its own array.
+// --------------------------------------------------------
+class AbsoluteIndexFilter : public Filter {
+ public:
+     // A run of whole days, as epoch days [first, end).
+     struct DaySpan {
+         int64_t first = 0;
+         int64_t end = 0;
+
+         bool operator==(const DaySpan& other) const = default;
+     };
+
+     AbsoluteIndexFilter(const Filter::Vector& filters) : Filter(FilterType::AbsoluteIndex) {
+         for (const auto& filter : filters) {
+             ingest(*filter);
+         }
+
+         std::sort(_days.begin(), _days.end(), [](const DaySpan& spanA, const DaySpan& spanB) {
+             return spanA.first < spanB.first || (spanA.first == spanB.first && spanA.end < spanB.end);
+         });
+         _days.erase(std::unique(_days.begin(), _days.end()), _days.end());
+
+         std::sort(_ranges.begin(), _ranges.end(), [](const Range& rgA, const Range& rgB) {
+             return rgA.start() < rgB.start() || (rgA.start() == rgB.start() && rgA.end() < rgB.end());
+         });
+         _ranges.erase(std::unique(_ranges.begin(), _ranges.end()), _ranges.end());
+
+         merge_runs();
+     }
+
+     static Pointer create(const Filter::Vector& filters) {
+         return make_filter<AbsoluteIndexFilter>(filters);
+     }
+
+     // Whether the filter can be folded into an index.
+     static bool indexable(const Filter& filter) {
+         switch (filter.type()) {
+         case FilterType::AbsoluteIndex:
+         case FilterType::Date:
+         case FilterType::Datetime:
+         case FilterType::StaticRange:
+         case FilterType::Year:
+             return true;
+         default:
+             return false;
+         }
+     }
+
+     std::optional<Range> next_range(const Datetime& dt) const override {
+         std::optional<Range> result;
+
+         // Days starting on the date of `dt` started at or before it.
+         auto day_iter = std::upper_bound(_days.begin(), _days.end(), epoch_days(dt.date()), [](int64_t day, const DaySpan& span) {
+             return day < span.first;
+         });
+
+         if (day_iter != _days.end()) {
+             result = day_range(dt.zone(), *day_iter);
+         }
+
+         auto range_iter = std::upper_bound(_ranges.begin(), _ranges.end(), dt, [](const Datetime& dt, const Range& range) {
+             return dt < range.start();
+         });
+
+         if (range_iter != _ranges.end() && (! result.has_value() || range_iter->start() < result->start())) {
+             result = range_iter->zone(dt.zone());
+         }
+
+         return result;
+     }
+
+     std::optional<Range> prev_range(const Datetime& dt) const override {
+         std::optional<Range> result;
+
+         auto day_iter = std::upper_bound(_days.begin(), _days.end(), epoch_days(dt.date()), [](int64_t day, const DaySpan& span) {
+             return day < span.first;
+         });
+
+         if (day_iter != _days.begin()) {
+             result = day_range(dt.zone(), *std::prev(day_iter));
+         }
+
+         auto range_iter = std::upper_bound(_ranges.begin(), _ranges.end(), dt, [](const Datetime& dt, const Range& range) {
+             return dt < range.start();
+         });
+
+         if (range_iter != _ranges.begin() && (! result.has_value() || std::prev(range_iter)->start() >= result->start())) {
+             result = std::prev(range_iter)->zone(dt.zone());
+         }
+
+         return result;
+     }
+
+     // Runs are merged through the arrays of contiguous days and ranges
+     // built with the index, so that a run of thousands of adjacent
+     // dates or ranges is found by binary search rather than stepped
+     // through one range at a time.
+     std::optional<Range> next_coalesced_range(const Datetime& dt) const override {
+         auto range = next_range(dt);
+
+         if (! range.has_value()) {
+             return {};
+         }
+
+         Range run = extend_run(dt.zone(), *range);
+
+         // Skip the rest of a run which started at or before `dt`.
+         if (run.start() <= dt) {
+             range = next_range(run.end());
+
+             if (! range.has_value()) {
+                 return {};
+             }
+
+             run = extend_run(dt.zone(), *range);
+         }
+
+         return run;
+     }
+
+     std::optional<Range> prev_coalesced_range(const Datetime& dt) const override {
+         auto range = prev_range(dt);
+
+         if (! range.has_value()) {
+             return {};
+         }
+
+         return extend_run(dt.zone(), *range);
+     }
+
+     size_t size() const {
+         return _days.size() + _ranges.size();
+     }
+
+     const std::vector<DaySpan>& days() const {
+         return _days;
+     }
+
+     const std::vector<Range>& ranges() const {
+         return _ranges;
+     }
+
+ protected:
+     std::string _repr() const override {
+         std::vector<std::string> reprs;
+
+         for (const auto& span : _days) {
+             reprs.push_back(date_from_epoch_days(span.first).isoformat() + "/" + std::to_string(span.end - span.first) + "d");
+         }
+
+         for (const auto& range : _ranges) {
+             std::ostringstream sb;
+             sb << range;
+             reprs.push_back(sb.str());
+         }
+
+         return moonlight::str::join(reprs, ",");
+     }
+
+     size_t _hash() const override {
+         size_t seed = 0;
+
+         for (const auto& span : _days) {
+             seed = hash_combine(hash_combine(seed, span.first), span.end);
+         }
+
+         for (const auto& range : _ranges) {
+             seed = hash_combine(hash_combine(seed, instant_millis(range.start())), instant_millis(range.end()));
+         }
+
+         return hash_combine(seed, size());
+     }
+
+     bool _equals(const Filter& other) const override {
+         const auto& filter = static_cast<const AbsoluteIndexFilter&>(other);
+         return _days == filter._days && _ranges == filter._ranges;
+     }
+
+ private:
+     void ingest(const Filter& filter) {
+         switch (filter.type()) {
+         case FilterType::AbsoluteIndex: {
+             const auto& index = static_cast<const AbsoluteIndexFilter&>(filter);
+             std::copy(index._days.begin(), index._days.end(), std::back_inserter(_days));
+             std::copy(index._ranges.begin(), index._ranges.end(), std::back_inserter(_ranges));
+             break;
+         }
+
+         case FilterType::Date: {
+             const int64_t day = epoch_days(static_cast<const DateFilter&>(filter).date());
+             _days.push_back({day, day + 1});
+             break;
+         }
+
+         case FilterType::Datetime: {
+             const Datetime& dt = static_cast<const DatetimeFilter&>(filter).dt();
+             _ranges.push_back(Range(dt, dt + Duration::of_seconds(1)));
+             break;
+         }
+
+         case FilterType::StaticRange:
+             _ranges.push_back(static_cast<const StaticRangeFilter&>(filter).range());
+             break;
+
+         case FilterType::Year: {
+             const int year = static_cast<const YearFilter&>(filter).year();
+             _days.push_back({epoch_days(year, Month::January, 1), epoch_days(year + 1, Month::January, 1)});
+             break;
+         }
+
+         default:
+             THROW(Error, "Filter can't be indexed as absolute: " + filter.type_name());
+         }
+     }
+
+     static Range day_range(const Zone& zone, const DaySpan& span) {
+         return Range(
+             Datetime(zone, date_from_epoch_days(span.first)),
+             Datetime(zone, date_from_epoch_days(span.end))
+         );
+     }
+
+     // Merges the days and the ranges which touch or overlap into runs.
+     // Runs of each kind are apart from one another and sorted, so the
+     // runs of a kind touching a range are found by binary search.
+     void merge_runs() {
+         for (const auto& span : _days) {
+             if (! _day_runs.empty() && span.first <= _day_runs.back().end) {
+                 _day_runs.back().end = std::max(_day_runs.back().end, span.end);
+             } else {
+                 _day_runs.push_back(span);
+             }
+         }
+
+         for (const auto& range : _ranges) {
+             if (! _range_runs.empty() && range.start() <= _range_runs.back().end()) {
+                 _range_runs.back() = Range(_range_runs.back().start(), std::max(_range_runs.back().end(), range.end()));
+             } else {
+                 _range_runs.push_back(range);
+             }
+         }
+     }
+
+     // Extends `first` by the runs of either kind it touches, until
+     // neither kind extends it any further.  Each pass takes in at
+     // least one more run, so this ends within the number of runs.
+     Range extend_run(const Zone& zone, const Range& first) const {
+         Datetime start = first.start();
+         Datetime end = first.end();
+
+         for (bool grew = true; grew;) {
+             grew = absorb(_day_runs, [&](const DaySpan& span) {
+                 return day_range(zone, span);
+             }, start, end);
+
+             grew = absorb(_range_runs, [&](const Range& range) {
+                 return range.zone(zone);
+             }, start, end) || grew;
+         }
+
+         return Range(start, end);
+     }
+
+     // Takes the runs touching [start, end] into it, returning whether
+     // it grew.
+     template<class T, class ToRange>
+     static bool absorb(const std::vector<T>& runs, const ToRange& to_range, Datetime& start, Datetime& end) {
+         auto first = std::partition_point(runs.begin(), runs.end(), [&](const T& run) {
+             return to_range(run).end() < start;
+         });
+         auto last = std::partition_point(first, runs.end(), [&](const T& run) {
+             return to_range(run).start() <= end;
+         });
+
+         if (first == last) {
+             return false;
+         }
+
+         const Datetime run_start = to_range(*first).start();
+         const Datetime run_end = to_range(*std::prev(last)).end();
+         bool grew = false;
+
+         if (run_start < start) {
+             start = run_start;
+             grew = true;
+         }
+
+         if (run_end > end) {
+             end = run_end;
+             grew = true;
+         }
+
+         return grew;
+     }
+
+     std::vector<DaySpan> _days;
+     std::vector<Range> _ranges;
+     std::vector<DaySpan> _day_runs;
+     std::vector<Range> _range_runs;
+};
+
+}
+
+#endif /* !__TIMEFILTER_ABSOLUTE_INDEX_H */
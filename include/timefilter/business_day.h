@@ -0,0 +1,575 @@
+/*
+ * business_day.h
+ *
+ * Author: Lain Musgrove (lain.proliant@gmail.com)
+ * Date: Sunday October 18, 2026
+ */
+
+#ifndef __TIMEFILTER_BUSINESS_DAY_H
+#define __TIMEFILTER_BUSINESS_DAY_H
+
+#include <array>
+#include "timefilter/constants.h"
+#include "timefilter/filter.h"
+#include "timefilter/intern.h"
+#include "timefilter/holidays.h"
+
+namespace timefilter {
+
+// --------------------------------------------------------
+// Matches business days: days whose weekday is in the
+// given set and which are not holidays.  With a non-zero
+// `nth`, matches only the nth business day of each month,
+// counting from the end of the month when negative.
+// --------------------------------------------------------
+class BusinessDayFilter : public Filter {
+ public:
+     struct MonthTable {
+         int last_day = 0;
+         std::array<uint8_t, 32> prefix = {};  // business days in [1, day]
+
+         int total() const {
+             return prefix[last_day];
+         }
+
+         // Returns the day of the nth (1-based) business day, or 0.
+         int day_of(int n) const {
+             if (n < 1 || n > total()) {
+                 return 0;
+             }
+
+             auto iter = std::lower_bound(prefix.begin() + 1, prefix.begin() + last_day + 1, n);
+             return std::distance(prefix.begin(), iter);
+         }
+     };
+
+     BusinessDayFilter(const std::set<Weekday>& weekdays, HolidaySet::Pointer holidays, int nth = 0) :
+     Filter(FilterType::BusinessDay), _weekdays(weekdays), _holidays(holidays), _nth(nth) {
+         validate();
+         precompute_tables();
+     }
+
+     BusinessDayFilter(const std::set<Weekday>& weekdays, const std::set<Date>& holidays = {}, int nth = 0) :
+     BusinessDayFilter(weekdays, HolidaySet::create(holidays), nth) { }
+
+     static Pointer create(const std::set<Weekday>& weekdays, HolidaySet::Pointer holidays, int nth = 0) {
+         return interned<BusinessDayFilter>(weekdays, holidays, nth);
+     }
+
+     static Pointer create(const std::set<Weekday>& weekdays, const std::set<Date>& holidays = {}, int nth = 0) {
+         return interned<BusinessDayFilter>(weekdays, holidays, nth);
+     }
+
+     static const std::set<Weekday>& default_weekdays() {
+         static const std::set<Weekday> weekdays = {
+             Weekday::Monday, Weekday::Tuesday, Weekday::Wednesday, Weekday::Thursday, Weekday::Friday
+         };
+         return weekdays;
+     }
+
+     std::optional<Range> next_range(const Datetime& dt) const override {
+         if (_nth == 0) {
+             return day_range(dt.zone(), advance(dt.date(), 1));
+         }
+
+         Date month = dt.date().start_of_month();
+
+         for (int x = 0; x < FRAME_SCAN_LIMIT; x++) {
+             auto date = nth_of_month(month.year(), month.month());
+             if (date.has_value() && dt < Datetime(dt.zone(), *date)) {
+                 return day_range(dt.zone(), *date);
+             }
+             month = month.next_month();
+         }
+
+         return {};
+     }
+
+     std::optional<Range> prev_range(const Datetime& dt) const override {
+         if (_nth == 0) {
+             const Date date = dt.date();
+             return day_range(dt.zone(), is_business_day(date) ? date : advance(date, -1));
+         }
+
+         Date month = dt.date().start_of_month();
+
+         for (int x = 0; x < FRAME_SCAN_LIMIT; x++) {
+             auto date = nth_of_month(month.year(), month.month());
+             if (date.has_value() && dt >= Datetime(dt.zone(), *date)) {
+                 return day_range(dt.zone(), *date);
+             }
+             month = month.prev_month();
+         }
+
+         return {};
+     }
+
+     // Month ends are counted by prefix sums, whole months by their
+     // totals and whole 400-year cycles by the total of a cycle, less
+     // what the holidays within them take away.
+     int64_t count(const Range& window) const override {
+         const auto [first_day, end_day] = day_span(window);
+
+         if (end_day <= first_day) {
+             return 0;
+         }
+
+         const Date first = date_from_epoch_days(first_day);
+         const Date last = date_from_epoch_days(end_day - 1);
+         const int64_t first_month = month_index(first.year(), first.month());
+         const int64_t last_month = month_index(last.year(), last.month());
+         const auto& first_table = month_table(first.year(), first.month());
+         const auto& last_table = month_table(last.year(), last.month());
+
+         if (first_month == last_month) {
+             return days_between(first_table, first.day(), last.day());
+         }
+
+         return days_between(first_table, first.day(), first_table.last_day)
+             + days_in_months(first_month + 1, last_month)
+             + days_between(last_table, 1, last.day());
+     }
+
+     // Holidays are finitely many dates, which is nothing in the long
+     // run, so a cycle's worth of plain business days is the density.
+     Density density() const override {
+         const double per_year = _cycle_count / 400.0;
+         return {per_year, per_year / DAYS_PER_YEAR};
+     }
+
+     bool is_business_day(const Date& date) const {
+         const auto& table = month_table(date.year(), date.month());
+         return table.prefix[date.day()] != table.prefix[date.day() - 1];
+     }
+
+     int business_days_in_month(int year, Month month) const {
+         return month_table(year, month).total();
+     }
+
+     std::optional<Date> nth_of_month(int year, Month month) const {
+         const auto& table = month_table(year, month);
+         const int n = _nth > 0 ? _nth : table.total() + _nth + 1;
+         const int day = table.day_of(n);
+
+         if (day == 0) {
+             return {};
+         }
+
+         return Date(year, month, day);
+     }
+
+     std::optional<MonthDays> month_days(int year, Month month) const override {
+         if (_nth != 0) {
+             auto date = nth_of_month(year, month);
+             return date.has_value() ? MonthDays{date->day(), date->day()} : MonthDays{};
+         }
+
+         const auto& table = month_table(year, month);
+
+         if (table.total() == 0) {
+             return MonthDays{};
+         }
+
+         return MonthDays{table.day_of(1), table.day_of(table.total())};
+     }
+
+     // Returns the date `n` business days after (or before, when
+     // negative) the given date, which need not be a business day.
+     // Whole months are skipped using their business day totals.
+     Date advance(const Date& date, int n) const {
+         if (n == 0) {
+             return date;
+         }
+
+         Date month = date.start_of_month();
+         const auto* table = &month_table(month.year(), month.month());
+         int remaining = std::abs(n);
+
+         if (n > 0) {
+             remaining += table->prefix[date.day()];
+
+             while (remaining > table->total()) {
+                 remaining -= table->total();
+                 month = month.next_month();
+                 table = &month_table(month.year(), month.month());
+             }
+
+             return Date(month.year(), month.month(), table->day_of(remaining));
+         }
+
+         remaining = table->prefix[date.day() - 1] - remaining + 1;
+
+         while (remaining < 1) {
+             month = month.prev_month();
+             table = &month_table(month.year(), month.month());
+             remaining += table->total();
+         }
+
+         return Date(month.year(), month.month(), table->day_of(remaining));
+     }
+
+     // Holidays are particular dates, so only plain business days
+     // repeat: weekly, or with the calendar if counted within months.
+     std::optional<Duration> cycle() const override {
+         if (! _holidays->empty()) {
+             return {};
+         }
+
+         return Duration::of_days(_nth == 0 ? 7 : DAYS_PER_CYCLE);
+     }
+
+     bool follows_calendar() const override {
+         return _holidays->empty();
+     }
+
+     const std::set<Weekday>& weekdays() const {
+         return _weekdays;
+     }
+
+     HolidaySet::Pointer holidays() const {
+         return _holidays;
+     }
+
+     int nth() const {
+         return _nth;
+     }
+
+ protected:
+     std::string _repr() const override {
+         static const std::string weekday_chrs = "UMTWHFS";
+         std::ostringstream sb;
+
+         for (auto weekday : _weekdays) {
+             sb << weekday_chrs[static_cast<std::underlying_type_t<Weekday>>(weekday)];
+         }
+
+         if (_nth != 0) {
+             sb << "/" << _nth;
+         }
+
+         if (! _holidays->empty()) {
+             sb << "," << _holidays->size() << " holidays";
+         }
+
+         return sb.str();
+     }
+
+     size_t _hash() const override {
+         return hash_combine(hash_values(_holidays->hash(), _weekdays), _nth);
+     }
+
+     bool _equals(const Filter& other) const override {
+         const auto& filter = static_cast<const BusinessDayFilter&>(other);
+         return _weekdays == filter._weekdays && _nth == filter._nth && *_holidays == *filter._holidays;
+     }
+
+     std::string _canonical() const override {
+         std::vector<std::string> dates;
+         for (const auto& date : _holidays->dates()) {
+             dates.push_back(date.isoformat());
+         }
+
+         std::ostringstream sb;
+         sb << _repr();
+
+         if (! dates.empty()) {
+             sb << ":" << moonlight::str::join(dates, ",");
+         }
+
+         return sb.str();
+     }
+
+ private:
+     void validate() const {
+         if (_weekdays.size() == 0) {
+             THROW(Error, "At least one weekday must be provided for BusinessDayFilter.");
+         }
+
+         if (_holidays == nullptr) {
+             THROW(Error, "A holiday set must be provided for BusinessDayFilter.");
+         }
+
+         if (_nth < -31 || _nth > 31) {
+             THROW(Error, "Offset x must be: '-31 <= x <= 31' for nth business day in BusinessDayFilter.");
+         }
+     }
+
+     static int month_key(int year, Month month) {
+         return year * 12 + static_cast<int>(month);
+     }
+
+     // Matching days in a month: its business days, or whether it
+     // has an nth business day.
+     int days_in(const MonthTable& table) const {
+         if (_nth == 0) {
+             return table.total();
+         }
+
+         return table.day_of(_nth > 0 ? _nth : table.total() + _nth + 1) != 0;
+     }
+
+     // Matching days within [first, last] of a month.
+     int days_between(const MonthTable& table, int first, int last) const {
+         if (_nth == 0) {
+             return table.prefix[last] - table.prefix[first - 1];
+         }
+
+         const int day = table.day_of(_nth > 0 ? _nth : table.total() + _nth + 1);
+         return day >= first && day <= last;
+     }
+
+     int64_t days_in_month(int64_t index) const {
+         return days_in(month_table(floor_div(index, 12), static_cast<Month>(floor_mod(index, 12))));
+     }
+
+     // Matching days in the months [a, b), counted by whole cycles
+     // where possible.
+     int64_t days_in_months(int64_t a, int64_t b) const {
+         int64_t n = 0;
+
+         for (; a < b && floor_mod(a, MONTHS_PER_CYCLE) != 0; a++) {
+             n += days_in_month(a);
+         }
+
+         if (b - a >= MONTHS_PER_CYCLE) {
+             const int64_t end = a + (b - a) / MONTHS_PER_CYCLE * MONTHS_PER_CYCLE;
+             n += (end - a) / MONTHS_PER_CYCLE * _cycle_count;
+
+             for (auto iter = _holiday_tables.lower_bound(a); iter != _holiday_tables.end() && iter->first < end; iter++) {
+                 const int year = floor_div(iter->first, 12);
+                 const Month month = static_cast<Month>(floor_mod(iter->first, 12));
+                 n += days_in(iter->second) - days_in(month_template(year, month));
+             }
+
+             a = end;
+         }
+
+         for (; a < b; a++) {
+             n += days_in_month(a);
+         }
+
+         return n;
+     }
+
+     bool is_business_weekday(int weekday_id) const {
+         return _weekdays.contains(static_cast<Weekday>(weekday_id % 7));
+     }
+
+     MonthTable build_table(int first_weekday_id, int last_day, uint32_t holiday_bits = 0) const {
+         MonthTable table;
+         table.last_day = last_day;
+
+         for (int day = 1; day <= last_day; day++) {
+             const bool holiday = (holiday_bits >> (day - 1)) & 1;
+             table.prefix[day] = table.prefix[day - 1] + (is_business_weekday(first_weekday_id + day - 1) && ! holiday ? 1 : 0);
+         }
+
+         return table;
+     }
+
+     // Months without holidays only depend on the weekday of their
+     // first day and their length, so 7 x 4 tables cover all of them.
+     // Months containing holidays get a table of their own.
+     void precompute_tables() {
+         for (int weekday_id = 0; weekday_id < 7; weekday_id++) {
+             for (int last_day = 28; last_day <= 31; last_day++) {
+                 _templates[weekday_id][last_day - 28] = build_table(weekday_id, last_day);
+             }
+         }
+
+         int64_t day = CYCLE_ANCHOR_DAYS;
+         for (int64_t index = 0; index < MONTHS_PER_CYCLE; index++) {
+             const int last_day = last_day_of_month(2000 + index / 12, static_cast<Month>(index % 12));
+             _cycle_count += days_in(_templates[epoch_weekday(day)][last_day - 28]);
+             day += last_day;
+         }
+
+         for (int year : _holidays->years()) {
+             for (int month_id = 0; month_id < 12; month_id++) {
+                 const Month month = static_cast<Month>(month_id);
+                 const uint32_t holiday_bits = _holidays->month_bits(year, month);
+
+                 if (holiday_bits == 0) {
+                     continue;
+                 }
+
+                 const int weekday_id = static_cast<std::underlying_type_t<Weekday>>(Date(year, month).weekday());
+                 _holiday_tables[month_key(year, month)] = build_table(weekday_id, last_day_of_month(year, month), holiday_bits);
+             }
+         }
+     }
+
+     const MonthTable& month_template(int year, Month month) const {
+         const int weekday_id = static_cast<std::underlying_type_t<Weekday>>(Date(year, month).weekday());
+         return _templates[weekday_id][last_day_of_month(year, month) - 28];
+     }
+
+     const MonthTable& month_table(int year, Month month) const {
+         if (! _holiday_tables.empty()) {
+             auto iter = _holiday_tables.find(month_key(year, month));
+             if (iter != _holiday_tables.end()) {
+                 return iter->second;
+             }
+         }
+
+         return month_template(year, month);
+     }
+
+     static Range day_range(const Zone& zone, const Date& date) {
+         return Range(
+             Datetime(zone, date),
+             Datetime(zone, date.advance_days(1))
+         );
+     }
+
+     const std::set<Weekday> _weekdays;
+     const HolidaySet::Pointer _holidays;
+     const int _nth;
+     std::array<std::array<MonthTable, 4>, 7> _templates;
+     std::map<int, MonthTable> _holiday_tables;
+     int64_t _cycle_count = 0;  // matching days in a cycle without holidays
+};
+
+// --------------------------------------------------------
+// Matches the day `days` business days after (or before,
+// when negative) the day each range of the given filter
+// starts on, e.g. "3 business days after month end", with
+// business days counted by a plain BusinessDayFilter.
+// There's no expression syntax for these, as there's none
+// for the business day calendars they count by.
+// --------------------------------------------------------
+class BusinessDayOffset : public Filter {
+ public:
+     BusinessDayOffset(Pointer filter, Pointer calendar, int days) :
+     Filter(FilterType::BusinessDayOffset), _filter(filter), _calendar(calendar), _days(days) {
+         validate();
+     }
+
+     static Pointer create(Pointer filter, Pointer calendar, int days) {
+         return make_filter<BusinessDayOffset>(filter, calendar, days);
+     }
+
+     std::optional<Range> next_range(const Datetime& dt) const override {
+         Datetime pivot = dt;
+
+         // Ranges starting before the (days + 1)th business day before
+         // `dt` are offset to a day before `dt`'s.
+         if (_days > 0) {
+             pivot = Datetime(dt.zone(), calendar().advance(dt.date(), -_days - 1)) - Duration::of_millis(1);
+         }
+
+         for (auto range = _filter->next_range(pivot); range.has_value(); ) {
+             const Range offset_rg = offset_range(dt.zone(), range->start().date());
+
+             if (dt < offset_rg.start()) {
+                 return offset_rg;
+             }
+
+             // Ranges starting on the same day have the same offset.
+             range = _filter->next_range(Datetime(dt.zone(), range->start().date().advance_days(1)) - Duration::of_millis(1));
+         }
+
+         return {};
+     }
+
+     std::optional<Range> prev_range(const Datetime& dt) const override {
+         Datetime pivot = dt;
+
+         // Ranges starting after the (days + 1)th business day after
+         // `dt` are offset to a day after `dt`'s.
+         if (_days < 0) {
+             const Date last = calendar().advance(dt.date(), -_days + 1);
+             pivot = Datetime(dt.zone(), last.advance_days(1)) - Duration::of_millis(1);
+         }
+
+         for (auto range = _filter->prev_range(pivot); range.has_value(); ) {
+             const Range offset_rg = offset_range(dt.zone(), range->start().date());
+
+             if (dt >= offset_rg.start()) {
+                 return offset_rg;
+             }
+
+             range = _filter->prev_range(Datetime(dt.zone(), range->start().date()) - Duration::of_millis(1));
+         }
+
+         return {};
+     }
+
+     std::optional<Duration> cycle() const override {
+         auto filter_cycle = _filter->cycle();
+         auto calendar_cycle = _calendar->cycle();
+
+         if (! filter_cycle.has_value() || ! calendar_cycle.has_value()) {
+             return {};
+         }
+
+         auto lcm = lcm_millis(to_millis(*filter_cycle), to_millis(*calendar_cycle));
+         if (! lcm.has_value()) {
+             return {};
+         }
+
+         return Duration::of_millis(*lcm);
+     }
+
+     Pointer filter() const {
+         return _filter;
+     }
+
+     const BusinessDayFilter& calendar() const {
+         return static_cast<const BusinessDayFilter&>(*_calendar);
+     }
+
+     int days() const {
+         return _days;
+     }
+
+ protected:
+     std::string _repr() const override {
+         std::ostringstream sb;
+         sb << _filter->repr() << " + " << _days << " business days";
+         return sb.str();
+     }
+
+     size_t _hash() const override {
+         return hash_combine(hash_combine(_filter->hash(), _calendar->hash()), _days);
+     }
+
+     bool _equals(const Filter& other) const override {
+         const auto& filter = static_cast<const BusinessDayOffset&>(other);
+         return _days == filter._days && _calendar->equals(*filter._calendar) && _filter->equals(*filter._filter);
+     }
+
+     std::string _canonical() const override {
+         std::ostringstream sb;
+         sb << _filter->canonical() << " + " << _days << " business days of " << _calendar->canonical();
+         return sb.str();
+     }
+
+ private:
+     void validate() const {
+         if (_calendar->type() != FilterType::BusinessDay || calendar().nth() != 0) {
+             THROW(Error, "Business days must be counted by a BusinessDayFilter without an nth day in BusinessDayOffset.");
+         }
+
+         if (_days == 0) {
+             THROW(Error, "Offset must be non-zero for BusinessDayOffset.");
+         }
+     }
+
+     // The day `_days` business days from `date`.
+     Range offset_range(const Zone& zone, const Date& date) const {
+         const Date offset = calendar().advance(date, _days);
+         return Range(
+             Datetime(zone, offset),
+             Datetime(zone, offset.advance_days(1))
+         );
+     }
+
+     Pointer _filter;
+     Pointer _calendar;
+     int _days;
+};
+
+}
+
+#endif /* !__TIMEFILTER_BUSINESS_DAY_H */
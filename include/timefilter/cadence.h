@@ -0,0 +1,149 @@
+/*
+ * cadence.h
+ *
+ * Author: Lain Musgrove (lain.proliant@gmail.com)
+ * Date: Sunday October 18, 2026
+ */
+
+#ifndef __TIMEFILTER_CADENCE_H
+#define __TIMEFILTER_CADENCE_H
+
+#include "timefilter/calendar.h"
+#include "timefilter/filter.h"
+#include "timefilter/intern.h"
+
+namespace timefilter {
+
+// --------------------------------------------------------
+// Matches a range of `unit` length once every `period`,
+// counting from a wall-clock anchor in the pivot's zone.
+// "every other week" is a 2w period with a 1w unit.
+// --------------------------------------------------------
+class CadenceFilter : public Filter {
+ public:
+     CadenceFilter(const Duration& period, const Duration& unit, const Datetime& anchor = default_anchor()) :
+     Filter(FilterType::Cadence), _period(period), _unit(unit), _anchor(anchor) {
+         validate();
+     }
+
+     static Pointer create(const Duration& period, const Duration& unit, const Datetime& anchor = default_anchor()) {
+         return interned<CadenceFilter>(period, unit, anchor);
+     }
+
+     static const Datetime& default_anchor() {
+         // The first Sunday of the Unix epoch, so that weekly
+         // cadences line up with weeks starting on Sunday.
+         static const Datetime anchor = Datetime(1970, Month::January, 4);
+         return anchor;
+     }
+
+     std::optional<Range> next_range(const Datetime& dt) const override {
+         return occurrence(dt.zone(), floor_div(local_millis(dt) - anchor_millis(), period_millis()) + 1);
+     }
+
+     std::optional<Range> prev_range(const Datetime& dt) const override {
+         return occurrence(dt.zone(), floor_div(local_millis(dt) - anchor_millis(), period_millis()));
+     }
+
+     int64_t count(const Range& window) const override {
+         const int64_t start = local_millis(window.start());
+         const int64_t end = local_millis(window.end().zone(window.start().zone()));
+         return count_congruent(start, end, floor_mod(anchor_millis(), period_millis()), period_millis());
+     }
+
+     Duration coverage(const Range& window) const override {
+         return _fixed_length_coverage(window, _unit);
+     }
+
+     Density density() const override {
+         return {
+             DAYS_PER_YEAR * MILLIS_PER_DAY / period_millis(),
+             static_cast<double>(to_millis(_unit)) / period_millis()
+         };
+     }
+
+     std::optional<Duration> min_spacing() const override {
+         return _period;
+     }
+
+     std::optional<Duration> cycle() const override {
+         return _period;
+     }
+
+     std::optional<Range> nth_next(const Datetime& dt, int64_t k) const override {
+         validate_nth(k);
+         return occurrence(dt.zone(), floor_div(local_millis(dt) - anchor_millis(), period_millis()) + k);
+     }
+
+     std::optional<Range> nth_prev(const Datetime& dt, int64_t k) const override {
+         validate_nth(k);
+         return occurrence(dt.zone(), floor_div(local_millis(dt) - anchor_millis(), period_millis()) - (k - 1));
+     }
+
+     const Duration& period() const {
+         return _period;
+     }
+
+     const Duration& unit() const {
+         return _unit;
+     }
+
+     const Datetime& anchor() const {
+         return _anchor;
+     }
+
+     bool is_subday() const {
+         return _unit < Duration::of_days(1);
+     }
+
+ protected:
+     std::string _repr() const override {
+         std::ostringstream sb;
+         sb << _period << "," << _unit << "," << _anchor.isoformat();
+         return sb.str();
+     }
+
+     size_t _hash() const override {
+         return hash_combine(hash_combine(hash_mix(period_millis()), to_millis(_unit)), anchor_millis());
+     }
+
+     bool _equals(const Filter& other) const override {
+         const auto& filter = static_cast<const CadenceFilter&>(other);
+         return _period == filter._period && _unit == filter._unit && anchor_millis() == filter.anchor_millis();
+     }
+
+ private:
+     void validate() const {
+         if (_unit <= Duration::zero()) {
+             THROW(Error, "Unit must be greater than zero for CadenceFilter.");
+         }
+
+         if (_period < _unit) {
+             THROW(Error, "Period must not be shorter than the unit for CadenceFilter.");
+         }
+     }
+
+     int64_t period_millis() const {
+         return to_millis(_period);
+     }
+
+     int64_t anchor_millis() const {
+         return local_millis(_anchor);
+     }
+
+     Range occurrence(const Zone& zone, int64_t n) const {
+         const int64_t start = anchor_millis() + n * period_millis();
+         return Range(
+             from_local_millis(zone, start),
+             from_local_millis(zone, start + to_millis(_unit))
+         );
+     }
+
+     const Duration _period;
+     const Duration _unit;
+     const Datetime _anchor;
+};
+
+}
+
+#endif /* !__TIMEFILTER_CADENCE_H */
@@ -0,0 +1,186 @@
+/*
+ * calendar.h
+ *
+ * Author: Lain Musgrove (lain.proliant@gmail.com)
+ * Date: Sunday October 18, 2026
+ */
+
+#ifndef __TIMEFILTER_CALENDAR_H
+#define __TIMEFILTER_CALENDAR_H
+
+#include <numeric>
+#include <optional>
+#include "moonlight/date.h"
+
+namespace timefilter {
+
+using namespace moonlight::date;
+
+// --------------------------------------------------------
+// Integer calendar arithmetic used by filters that jump
+// directly to an occurrence instead of scanning for it.
+// Local times are treated as a linear wall-clock timeline
+// measured in milliseconds from 1970-01-01 00:00.
+// --------------------------------------------------------
+const int64_t MILLIS_PER_DAY = 86400000;
+
+// The Gregorian calendar repeats every 400 years, which is
+// also a whole number of weeks.
+const int64_t DAYS_PER_CYCLE = 146097;
+const int64_t MONTHS_PER_CYCLE = 400 * 12;
+
+// Between the leap days skipped in years like 2100, the calendar
+// repeats every 28 years.
+const int64_t DAYS_PER_SOLAR_CYCLE = 28 * 365 + 7;
+
+// 2000-01-01, the first day of a cycle, as an epoch day.
+const int64_t CYCLE_ANCHOR_DAYS = 10957;
+
+// The mean length of a year over the cycle.
+const double DAYS_PER_YEAR = double(DAYS_PER_CYCLE) / 400;
+
+// Periods longer than this are treated as having no useful period.
+const int64_t MAX_PERIOD_MILLIS = DAYS_PER_CYCLE * MILLIS_PER_DAY * 16;
+
+inline int64_t floor_div(int64_t a, int64_t b) {
+    int64_t q = a / b;
+    if ((a % b != 0) && ((a < 0) != (b < 0))) {
+        q--;
+    }
+    return q;
+}
+
+inline int64_t floor_mod(int64_t a, int64_t b) {
+    return a - floor_div(a, b) * b;
+}
+
+inline int64_t to_millis(const Duration& duration) {
+    return duration.millis().count();
+}
+
+inline int64_t epoch_days(int year, Month month, int day) {
+    int64_t y = year;
+    int64_t m = static_cast<int64_t>(month) + 1;
+    y -= m <= 2;
+    const int64_t era = floor_div(y, 400);
+    const int64_t yoe = y - era * 400;
+    const int64_t doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + day - 1;
+    const int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+inline int64_t epoch_days(const Date& date) {
+    return epoch_days(date.year(), date.month(), date.day());
+}
+
+inline Date date_from_epoch_days(int64_t days) {
+    const int64_t z = days + 719468;
+    const int64_t era = floor_div(z, 146097);
+    const int64_t doe = z - era * 146097;
+    const int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const int64_t mp = (5 * doy + 2) / 153;
+    const int day = static_cast<int>(doy - (153 * mp + 2) / 5 + 1);
+    const int month = static_cast<int>(mp < 10 ? mp + 3 : mp - 9);
+    const int year = static_cast<int>(yoe + era * 400 + (month <= 2));
+    return Date(year, month, day);
+}
+
+// Number of integers n in [a, b) where n = r (mod m).
+inline int64_t count_congruent(int64_t a, int64_t b, int64_t r, int64_t m) {
+    if (b <= a) {
+        return 0;
+    }
+    return floor_div(b - r + m - 1, m) - floor_div(a - r + m - 1, m);
+}
+
+// The least common multiple of two periods, if it isn't too long.
+inline std::optional<int64_t> lcm_millis(int64_t a, int64_t b) {
+    const int64_t gcd = std::gcd(a, b);
+
+    if (a / gcd > MAX_PERIOD_MILLIS / b) {
+        return {};
+    }
+
+    return a / gcd * b;
+}
+
+// Number of leap years in [y0, y1).
+inline int64_t count_leap_years(int64_t y0, int64_t y1) {
+    auto leaps_before = [](int64_t y) {
+        return floor_div(y + 3, 4) - floor_div(y + 99, 100) + floor_div(y + 399, 400);
+    };
+    return leaps_before(y1) - leaps_before(y0);
+}
+
+// Calls `f(last_day, share)` for each length the month has over the
+// cycle, with the share of years in which it has that length.
+template<class F>
+inline void for_each_month_length(Month month, F f) {
+    if (month == Month::February) {
+        f(28, 303.0 / 400);
+        f(29, 97.0 / 400);
+    } else {
+        f(last_day_of_month(2001, month), 1.0);
+    }
+}
+
+// 0 = Sunday, matching the Weekday enumeration.
+inline int epoch_weekday(int64_t days) {
+    return static_cast<int>(floor_mod(days + 4, 7));
+}
+
+inline int64_t month_index(int year, Month month) {
+    return int64_t(year) * 12 + static_cast<int64_t>(month);
+}
+
+inline int64_t local_millis(const Datetime& dt) {
+    return epoch_days(dt.date()) * MILLIS_PER_DAY
+        + to_millis(dt - Datetime(dt.zone(), dt.date()));
+}
+
+inline Datetime from_local_millis(const Zone& zone, int64_t millis) {
+    const Date date = date_from_epoch_days(floor_div(millis, MILLIS_PER_DAY));
+    return Datetime(zone, date) + Duration::of_millis(floor_mod(millis, MILLIS_PER_DAY));
+}
+
+// Milliseconds between the Unix epoch and `dt` as an instant,
+// whatever its zone.
+inline int64_t instant_millis(const Datetime& dt) {
+    return to_millis(dt - Datetime(Date(1970, Month::January, 1), Time(0, 0)));
+}
+
+// The epoch day of the first local midnight at or after `dt`.
+inline int64_t first_day_at_or_after(const Datetime& dt) {
+    const int64_t days = epoch_days(dt.date());
+    return dt > Datetime(dt.zone(), dt.date()) ? days + 1 : days;
+}
+
+// The month index of the first month start at or after `dt`.
+inline int64_t first_month_at_or_after(const Datetime& dt) {
+    const Date date = dt.date();
+    const int64_t index = month_index(date.year(), date.month());
+    return dt > Datetime(dt.zone(), Date(date.year(), date.month())) ? index + 1 : index;
+}
+
+// The first and last days of a month on which a filter matches,
+// or {0, 0} if it matches none of them.
+struct MonthDays {
+    int first = 0;
+    int last = 0;
+
+    bool empty() const {
+        return first == 0;
+    }
+};
+
+// The epoch days [a, b) whose local midnight falls within the window,
+// measured in the zone of the window's start.
+inline std::pair<int64_t, int64_t> day_span(const Range& window) {
+    const Zone& zone = window.start().zone();
+    return {first_day_at_or_after(window.start()), first_day_at_or_after(window.end().zone(zone))};
+}
+
+}
+
+#endif /* !__TIMEFILTER_CALENDAR_H */
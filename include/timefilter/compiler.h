@@ -16,6 +16,8 @@
 #include "timefilter/relative_range.h"
 #include "timefilter/set.h"
 #include "moonlight/string.h"
+#include <limits>
+#include <stdexcept>
 
 namespace timefilter {
 
@@ -39,8 +41,9 @@ class Compiler {
 
      struct Context {
          FilterList::Pointer list = FilterList::create();
-         FilterSet::Pointer set = nullptr;
-         std::deque<Grammar::Token> tokens;
+         Filter::Vector terms = Filter::Vector(MemoryScope::resource());
+         std::vector<std::pair<size_t, FilterSet::Pointer>> at_sets;
+         std::pmr::deque<Grammar::Token> tokens = std::pmr::deque<Grammar::Token>(MemoryScope::resource());
          std::optional<Duration> duration;
          Token last_token = Token(TokenType::COMMENT, moonlight::rx::Capture());
 
@@ -60,6 +63,13 @@ class Compiler {
              tokens.pop_front();
              return last_token;
          }
+
+         // The terms since the last operator, added to a set at once.
+         FilterSet::Pointer take_set() {
+             auto set = FilterSet::create()->add(terms);
+             terms.clear();
+             return set;
+         }
      };
 
      Filter::Pointer compile_filter(const std::vector<Grammar::Token>& tokens) const {
@@ -67,14 +77,13 @@ class Compiler {
          std::copy(tokens.begin(), tokens.end(), std::back_inserter(ctx.tokens));
 
          auto machine = state_machine(ctx, FILTER);
-         ctx.set = FilterSet::create();
          machine.run_until_complete();
 
-         if (! ctx.set->empty()) {
-             ctx.list->push(ctx.set);
+         if (! ctx.terms.empty()) {
+             ctx.list->push(ctx.take_set());
          }
 
-         return ctx.list->simplify();
+         return apply_at_sets(ctx)->simplify();
      }
 
      Duration compile_duration(const std::vector<Grammar::Token>& tokens) const {
@@ -105,12 +114,11 @@ class Compiler {
              switch (token.type()) {
              case TokenType::OP_RANGE:
                  ctx.pop_token();
-                 if (ctx.set->empty()) {
+                 if (ctx.terms.empty()) {
                      THROW_COMPILE("Empty filter set is invalid for left-hand size of range.", token);
                  }
 
-                 ctx.list->push(ctx.set);
-                 ctx.set = FilterSet::create();
+                 ctx.list->push(ctx.take_set());
                  m.push(FILTER_RANGE);
                  m.push(FILTER);
                  break;
@@ -123,9 +131,8 @@ class Compiler {
                  }
 
                  ctx.pop_token();
-                 if (! ctx.set->empty()) {
-                     ctx.list->push(ctx.set);
-                     ctx.set = FilterSet::create();
+                 if (! ctx.terms.empty()) {
+                     ctx.list->push(ctx.take_set());
                  }
 
                  m.push(FILTER_AT);
@@ -139,12 +146,12 @@ class Compiler {
                  break;
 
              case TokenType::OP_JOIN:
-                 if (ctx.set->empty()) {
+                 ctx.pop_token();
+                 if (ctx.terms.empty()) {
                      THROW_COMPILE("Empty filter set is invalid.", ctx.last_token);
                  }
 
-                 ctx.list->push(ctx.set);
-                 ctx.set = FilterSet::create();
+                 ctx.list->push(ctx.take_set());
                  break;
 
              case TokenType::COMMENT:
@@ -152,7 +159,7 @@ class Compiler {
                  break;
 
              default:
-                 ctx.set->add(parse_filter_token(token));
+                 ctx.terms.push_back(parse_filter_token(token));
                  ctx.pop_token();
                  break;
              }
@@ -166,9 +173,9 @@ class Compiler {
              auto token = ctx.front_token();
 
              if (token.type() == TokenType::DURATION) {
-                 const int64_t value = std::stoll(token.capture().group(1));
                  const std::string suffix = token.capture().group(2);
                  auto factory = parse_duration_factory(suffix);
+                 const int64_t value = parse_count(token.capture().group(1), factory, token);
 
                  if (ctx.duration.has_value()) {
                      ctx.duration.value() += factory(value);
@@ -185,73 +192,93 @@ class Compiler {
              if (! ctx.duration.has_value()) {
                  THROW_COMPILE("No duration provided.", ctx.last_token);
              }
-             ctx.list->push(FilterDuration::create(ctx.set, ctx.duration.value()));
+             ctx.list->push(FilterDuration::create(ctx.take_set(), ctx.duration.value()));
              ctx.duration.reset();
-             ctx.set = FilterSet::create();
              m.pop();
          })
          .state(FILTER_AT, [&](auto& m) {
-             std::vector<Filter::Pointer> filters;
-
              if (ctx.list->empty()) {
                  THROW(CompilerError, "Empty list is invalid for left-hand size of set-joiner.");
              }
 
-             while (! ctx.list->empty()) {
-                 auto top_filter = ctx.list->pop();
-
-                 switch (top_filter->type()) {
-                 case FilterType::FilterSet: {
-                     auto filter_set = std::static_pointer_cast<FilterSet>(std::const_pointer_cast<Filter>(top_filter));
-                     filter_set->add(ctx.set);
-                     filters.push_back(filter_set);
-                     break;
-                 }
-                 case FilterType::RelativeRange: {
-                     auto range = std::static_pointer_cast<const RelativeRangeFilter>(top_filter);
-                     if (range->start_filter()->type() != FilterType::FilterSet) {
-                         THROW(CompilerError, "Unexpected start filter in RelativeRangeFilter while merging sets: " + range->start_filter()->repr());
-                     }
-                     auto filter_set = std::static_pointer_cast<FilterSet>(std::const_pointer_cast<Filter>(range->start_filter()));
-                     filter_set->add(ctx.set);
-                     filters.push_back(RelativeRangeFilter::create(filter_set, range->end_filter()));
-                     break;
-                 }
-                 case FilterType::Duration: {
-                     auto duration = std::static_pointer_cast<const FilterDuration>(top_filter);
-                     if (duration->filter()->type() != FilterType::FilterSet) {
-                         THROW(CompilerError, "Unexpected filter in FilterDuration while merging sets: " + duration->filter()->repr());
-                     }
-                     auto filter_set = std::static_pointer_cast<FilterSet>(std::const_pointer_cast<Filter>(duration->filter()));
-                     filter_set->add(ctx.set);
-                     filters.push_back(FilterDuration::create(filter_set, duration->duration()));
-                     break;
-                 }
-                 default:
-                     THROW(CompilerError, "Unexpected filter type in context filter list: " + top_filter->repr());
-                 }
-             }
-
-             for (auto filter : filters) {
-                 ctx.list->push(filter);
-             }
-
-             ctx.set = FilterSet::create();
+             // Applied to every filter listed so far once compiling is done.
+             ctx.at_sets.push_back({ctx.list->size(), ctx.take_set()});
              m.pop();
          })
          .state(FILTER_RANGE, [&](auto& m) {
-             if (ctx.set->empty()) {
+             if (ctx.terms.empty()) {
                  THROW_COMPILE("Empty right-hand set is invalid for filter range.", ctx.last_token);
              }
 
              auto rhs = ctx.list->pop();
-             ctx.list->push(RelativeRangeFilter::create(rhs, ctx.set));
-             ctx.set = FilterSet::create();
+             ctx.list->push(RelativeRangeFilter::create(rhs, ctx.take_set()));
              m.pop();
          })
          .build();
      }
 
+     // Each "@" adds its set to every filter listed before it.  The
+     // sets are combined from the last "@" backwards, so that each
+     // filter is rewritten once with all of the sets which apply to it.
+     static FilterList::Pointer apply_at_sets(const Context& ctx) {
+         if (ctx.at_sets.empty()) {
+             return ctx.list;
+         }
+
+         std::vector<FilterSet::Pointer> combined(ctx.at_sets.size());
+
+         for (size_t x = ctx.at_sets.size(); x-- > 0;) {
+             Filter::Vector sets({ctx.at_sets[x].second}, MemoryScope::resource());
+             if (x + 1 < combined.size()) {
+                 sets.push_back(combined[x + 1]);
+             }
+             combined[x] = FilterSet::create()->add(sets);
+         }
+
+         auto list = FilterList::create();
+         const auto& filters = ctx.list->filters();
+         size_t at = 0;
+
+         for (size_t x = 0; x < filters.size(); x++) {
+             while (at < ctx.at_sets.size() && ctx.at_sets[at].first <= x) {
+                 at++;
+             }
+
+             list->push(at < combined.size() ? apply_at_set(filters[x], combined[at]) : filters[x]);
+         }
+
+         return list;
+     }
+
+     static Filter::Pointer apply_at_set(Filter::Pointer filter, FilterSet::Pointer set) {
+         switch (filter->type()) {
+         case FilterType::FilterSet: {
+             auto filter_set = std::static_pointer_cast<FilterSet>(std::const_pointer_cast<Filter>(filter));
+             return filter_set->add(set);
+         }
+         case FilterType::RelativeRange: {
+             auto range = std::static_pointer_cast<const RelativeRangeFilter>(filter);
+             if (range->start_filter()->type() != FilterType::FilterSet) {
+                 THROW(CompilerError, "Unexpected start filter in RelativeRangeFilter while merging sets: " + range->start_filter()->repr());
+             }
+             auto filter_set = std::static_pointer_cast<FilterSet>(std::const_pointer_cast<Filter>(range->start_filter()));
+             filter_set->add(set);
+             return RelativeRangeFilter::create(filter_set, range->end_filter());
+         }
+         case FilterType::Duration: {
+             auto duration = std::static_pointer_cast<const FilterDuration>(filter);
+             if (duration->filter()->type() != FilterType::FilterSet) {
+                 THROW(CompilerError, "Unexpected filter in FilterDuration while merging sets: " + duration->filter()->repr());
+             }
+             auto filter_set = std::static_pointer_cast<FilterSet>(std::const_pointer_cast<Filter>(duration->filter()));
+             filter_set->add(set);
+             return FilterDuration::create(filter_set, duration->duration());
+         }
+         default:
+             THROW(CompilerError, "Unexpected filter type in context filter list: " + filter->repr());
+         }
+     }
+
      static std::function<Duration(int64_t)> parse_duration_factory(const std::string& suffix) {
          static std::map<std::string, std::function<Duration(int64_t)>> factories = {
              {"h", Duration::of_hours},
@@ -276,6 +303,9 @@ class Compiler {
          int factor = 1;
 
          switch(tk.type()) {
+         case TokenType::CADENCE:
+             return parse_cadence_token(tk);
+
          case TokenType::DAY_MONTH:
              day = std::stoi(tk.capture().group(1));
              month = _i18n.month(tk.capture().group(3));
@@ -417,6 +447,51 @@ class Compiler {
          }
      }
 
+     static Filter::Pointer parse_cadence_token(const Token& tk) {
+         const std::string count_str = moonlight::str::to_lower(tk.capture().group(1));
+         int64_t count = 1;
+
+         // Unit names are normalized to the single-character duration suffixes.
+         auto factory = parse_duration_factory(moonlight::str::chr(tk.capture().group(2)[0]));
+         const Duration unit = factory(1);
+
+         if (count_str.starts_with("other")) {
+             count = 2;
+         } else if (count_str.size() > 0) {
+             count = parse_count(count_str, factory, tk);
+         }
+
+         if (count < 1) {
+             THROW_COMPILE("Cadence count must be at least 1.", tk);
+         }
+
+         if (tk.capture().group(3).size() > 0) {
+             const Date anchor_date = Date(std::stoi(tk.capture().group(3)),
+                                           std::stoi(tk.capture().group(4)),
+                                           std::stoi(tk.capture().group(5)));
+             return CadenceFilter::create(factory(count), unit, Datetime(anchor_date));
+         }
+
+         return CadenceFilter::create(factory(count), unit);
+     }
+
+     // A count of units, which must fit in a Duration once multiplied out.
+     static int64_t parse_count(const std::string& count_str, const std::function<Duration(int64_t)>& factory, const Token& tk) {
+         int64_t count = 0;
+
+         try {
+             count = std::stoll(count_str);
+         } catch (const std::out_of_range&) {
+             THROW_COMPILE("Count is out of range.", tk);
+         }
+
+         if (count > std::numeric_limits<int64_t>::max() / to_millis(factory(1))) {
+             THROW_COMPILE("Count is out of range.", tk);
+         }
+
+         return count;
+     }
+
      static const std::string& weekday_offsets() {
          static const std::string offsets = "umtwhfs";
          return offsets;
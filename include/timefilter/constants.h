@@ -8,9 +8,21 @@
 #ifndef __TIMEFILTER_CONSTANTS_H
 #define __TIMEFILTER_CONSTANTS_H
 
+#include <cstddef>
+
 namespace timefilter {
 
 const int FRAME_SCAN_LIMIT = 100;
+const int LEAPFROG_STEP_LIMIT = 10000;
+const int COALESCE_STEP_LIMIT = 100000;
+const size_t INTERN_SHARDS = 16;
+const size_t INTERN_SWEEP_MIN = 64;
+const size_t SET_STACK_DEPTH = 6;
+const size_t ABSOLUTE_INDEX_MIN = 16;
+const int DENSITY_SAMPLE_START_YEAR = 2000;
+const int DENSITY_SAMPLE_YEARS = 28;
+const double PLAN_LEAPFROG_AGREEMENT = 0.1;
+const int CRON_MONTH_LIMIT = 4800;
 
 }
 
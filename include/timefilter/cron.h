@@ -0,0 +1,280 @@
+/*
+ * cron.h
+ *
+ * Author: Lain Musgrove (lain.proliant@gmail.com)
+ * Date: Sunday October 18, 2026
+ */
+
+#ifndef __TIMEFILTER_CRON_H
+#define __TIMEFILTER_CRON_H
+
+#include <array>
+#include <bit>
+#include "timefilter/constants.h"
+#include "timefilter/filter.h"
+#include "timefilter/month.h"
+#include "timefilter/monthday.h"
+#include "timefilter/time.h"
+#include "timefilter/weekday.h"
+#include "timefilter/weekday_monthday.h"
+
+namespace timefilter {
+
+// --------------------------------------------------------
+// The month, day of month, weekday and time filters of a set
+// as cron-style fields: a bit for each month, each day of a
+// month of each length, each day of a month starting on each
+// weekday, each hour and each minute of the hour.  Unlike
+// cron, a day must match both its day of the month and its
+// weekday.  The next and previous minutes are found by
+// carrying from the minute into the hour, the day and the
+// month, a few bit operations at a time.
+//
+// Times aren't a product of hours and minutes, so each hour
+// has its own minutes.
+// --------------------------------------------------------
+class CronTable {
+ public:
+     CronTable(const Filter::Vector& filters) {
+         std::array<bool, 7> weekdays;
+         weekdays.fill(true);
+
+         for (int last_day = 28; last_day <= 31; last_day++) {
+             for (int day = 1; day <= last_day; day++) {
+                 _monthdays[last_day - 28] |= 1u << day;
+             }
+         }
+
+         for (const auto& filter : filters) {
+             switch (filter->type()) {
+             case FilterType::Month:
+                 _months = 0;
+                 for (auto month : static_cast<const MonthFilter&>(*filter).months()) {
+                     _months |= 1u << static_cast<int>(month);
+                 }
+                 break;
+
+             case FilterType::Monthday:
+                 mask_monthdays([&](int day, int last_day) {
+                     return static_cast<const MonthdayFilter&>(*filter).matches(day, last_day);
+                 });
+                 break;
+
+             case FilterType::Weekday:
+                 mask_weekdays(weekdays, static_cast<const WeekdayFilter&>(*filter).weekdays());
+                 break;
+
+             case FilterType::WeekdayMonthday: {
+                 const auto& weekday_monthdays = static_cast<const WeekdayMonthdayFilter&>(*filter);
+                 mask_monthdays([&](int day, int last_day) {
+                     return weekday_monthdays.matches_monthday(day, last_day);
+                 });
+                 mask_weekdays(weekdays, weekday_monthdays.weekdays());
+                 break;
+             }
+
+             case FilterType::Time: {
+                 const auto minutes = *static_cast<const TimeFilter&>(*filter).minutes_of_day();
+                 for (int minute = 0; minute < TimeFilter::MINUTES_PER_DAY; minute++) {
+                     if (minutes.test(minute)) {
+                         _hours |= 1u << (minute / 60);
+                         _minutes[minute / 60] |= uint64_t(1) << (minute % 60);
+                     }
+                 }
+                 break;
+             }
+
+             default:
+                 THROW(Error, "Filter can't be expressed as a cron field: " + filter->type_name());
+             }
+         }
+
+         for (int first_weekday = 0; first_weekday < 7; first_weekday++) {
+             for (int day = 1; day <= 31; day++) {
+                 if (weekdays[(first_weekday + day - 1) % 7]) {
+                     _weekdays[first_weekday] |= 1u << day;
+                 }
+             }
+         }
+     }
+
+     // Whether the filters are all month, day or time filters, with
+     // one time filter whose times are all on the minute.
+     static bool eligible(const Filter::Vector& filters) {
+         bool has_minutes = false;
+
+         for (const auto& filter : filters) {
+             switch (filter->type()) {
+             case FilterType::Month:
+             case FilterType::Monthday:
+             case FilterType::Weekday:
+             case FilterType::WeekdayMonthday:
+                 break;
+
+             case FilterType::Time:
+                 if (! static_cast<const TimeFilter&>(*filter).minutes_of_day().has_value()) {
+                     return false;
+                 }
+                 has_minutes = true;
+                 break;
+
+             default:
+                 return false;
+             }
+         }
+
+         return has_minutes;
+     }
+
+     std::optional<Range> next_range(const Datetime& dt) const {
+         const int64_t minute = floor_div(local_millis(dt), TimeFilter::MILLIS_PER_MINUTE) + 1;
+         const Date date = date_from_epoch_days(floor_div(minute, TimeFilter::MINUTES_PER_DAY));
+         int year = date.year();
+         int month = static_cast<int>(date.month());
+         int first_day = date.day();
+         int first_minute = floor_mod(minute, TimeFilter::MINUTES_PER_DAY);
+
+         for (int x = 0; x < CRON_MONTH_LIMIT; x++) {
+             if (_months & (1u << month)) {
+                 for (uint32_t days = day_mask(year, month) & (~0u << first_day); days != 0; days &= days - 1) {
+                     const int day = std::countr_zero(days);
+
+                     // On a day the clocks go back, a matching minute
+                     // can name an instant at or before `dt`.
+                     for (int found = next_minute(day == first_day ? first_minute : 0); found >= 0;
+                          found = found + 1 < TimeFilter::MINUTES_PER_DAY ? next_minute(found + 1) : -1) {
+                         const Range range = minute_range(dt.zone(), year, month, day, found);
+                         if (range.start() > dt) {
+                             return range;
+                         }
+                     }
+                 }
+             }
+
+             if (++month == 12) {
+                 month = 0;
+                 year++;
+             }
+             first_day = 1;
+             first_minute = 0;
+         }
+
+         return {};
+     }
+
+     std::optional<Range> prev_range(const Datetime& dt) const {
+         const int64_t minute = floor_div(local_millis(dt), TimeFilter::MILLIS_PER_MINUTE);
+         const Date date = date_from_epoch_days(floor_div(minute, TimeFilter::MINUTES_PER_DAY));
+         int year = date.year();
+         int month = static_cast<int>(date.month());
+         int last_day = date.day();
+         int last_minute = floor_mod(minute, TimeFilter::MINUTES_PER_DAY);
+
+         for (int x = 0; x < CRON_MONTH_LIMIT; x++) {
+             if (_months & (1u << month)) {
+                 // All of the days up to and including `last_day`.
+                 uint32_t days = day_mask(year, month) & ((2u << last_day) - 1);
+
+                 for (; days != 0; days &= ~(1u << (31 - std::countl_zero(days)))) {
+                     const int day = 31 - std::countl_zero(days);
+
+                     // Likewise, one can name an instant after `dt`.
+                     for (int found = prev_minute(day == last_day ? last_minute : TimeFilter::MINUTES_PER_DAY - 1); found >= 0;
+                          found = found > 0 ? prev_minute(found - 1) : -1) {
+                         const Range range = minute_range(dt.zone(), year, month, day, found);
+                         if (range.start() <= dt) {
+                             return range;
+                         }
+                     }
+                 }
+             }
+
+             if (--month < 0) {
+                 month = 11;
+                 year--;
+             }
+             last_day = 31;
+             last_minute = TimeFilter::MINUTES_PER_DAY - 1;
+         }
+
+         return {};
+     }
+
+ private:
+     template<class Matches>
+     void mask_monthdays(Matches matches) {
+         for (int last_day = 28; last_day <= 31; last_day++) {
+             for (int day = 1; day <= last_day; day++) {
+                 if (! matches(day, last_day)) {
+                     _monthdays[last_day - 28] &= ~(1u << day);
+                 }
+             }
+         }
+     }
+
+     static void mask_weekdays(std::array<bool, 7>& weekdays, const std::set<Weekday>& matching) {
+         for (int weekday = 0; weekday < 7; weekday++) {
+             weekdays[weekday] = weekdays[weekday] && matching.contains(static_cast<Weekday>(weekday));
+         }
+     }
+
+     // The matching days of the month, as bits 1 to 31.
+     uint32_t day_mask(int year, int month) const {
+         const int last_day = last_day_of_month(year, static_cast<Month>(month));
+         const int first_weekday = epoch_weekday(epoch_days(year, static_cast<Month>(month), 1));
+         return _monthdays[last_day - 28] & _weekdays[first_weekday];
+     }
+
+     // The first matching minute of the day at or after `from`, or -1.
+     int next_minute(int from) const {
+         const int hour = from / 60;
+         const uint64_t minutes = _minutes[hour] & (~uint64_t(0) << (from % 60));
+
+         if (minutes != 0) {
+             return hour * 60 + std::countr_zero(minutes);
+         }
+
+         const uint32_t hours = _hours & (~0u << (hour + 1));
+
+         if (hours == 0) {
+             return -1;
+         }
+
+         const int next_hour = std::countr_zero(hours);
+         return next_hour * 60 + std::countr_zero(_minutes[next_hour]);
+     }
+
+     // The last matching minute of the day at or before `to`, or -1.
+     int prev_minute(int to) const {
+         const int hour = to / 60;
+         const uint64_t minutes = _minutes[hour] & (~uint64_t(0) >> (63 - to % 60));
+
+         if (minutes != 0) {
+             return hour * 60 + 63 - std::countl_zero(minutes);
+         }
+
+         const uint32_t hours = _hours & ((1u << hour) - 1);
+
+         if (hours == 0) {
+             return -1;
+         }
+
+         const int prev_hour = 31 - std::countl_zero(hours);
+         return prev_hour * 60 + 63 - std::countl_zero(_minutes[prev_hour]);
+     }
+
+     static Range minute_range(const Zone& zone, int year, int month, int day, int minute) {
+         auto dt = Datetime(zone, Date(year, static_cast<Month>(month), day), Time(minute / 60, minute % 60));
+         return Range(dt, dt + Duration::of_minutes(1));
+     }
+
+     uint32_t _months = 0xfff;
+     std::array<uint32_t, 4> _monthdays = {};  // by last day - 28
+     std::array<uint32_t, 7> _weekdays = {};  // by weekday of the 1st, 0 = Sunday
+     uint32_t _hours = 0;
+     std::array<uint64_t, 24> _minutes = {};
+};
+
+}
+
+#endif /* !__TIMEFILTER_CRON_H */
@@ -9,6 +9,7 @@
 #define __TIMEFILTER_DATE_H
 
 #include "timefilter/filter.h"
+#include "timefilter/intern.h"
 
 namespace timefilter {
 
@@ -17,7 +18,7 @@ class DateFilter : public Filter {
      DateFilter(const Date& date) : Filter(FilterType::Date), _date(date) { }
 
      static Pointer create(const Date& date) {
-         return std::make_shared<DateFilter>(date);
+         return interned<DateFilter>(date);
      }
 
      std::optional<Range> next_range(const Datetime& dt) const override {
@@ -36,6 +37,14 @@ class DateFilter : public Filter {
          return {};
      }
 
+     std::optional<MonthDays> month_days(int year, Month month) const override {
+         if (year == _date.year() && month == _date.month()) {
+             return MonthDays{_date.day(), _date.day()};
+         }
+
+         return MonthDays{};
+     }
+
      const Date& date() const {
          return _date;
      }
@@ -45,6 +54,15 @@ class DateFilter : public Filter {
          return _date.isoformat();
      }
 
+     size_t _hash() const override {
+         return hash_mix(epoch_days(_date));
+     }
+
+     bool _equals(const Filter& other) const override {
+         const auto& filter = static_cast<const DateFilter&>(other);
+         return _date == filter._date;
+     }
+
  private:
      Range range(const Zone& zone) const {
          return Range(
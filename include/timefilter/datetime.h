@@ -9,6 +9,7 @@
 #define __TIMEFILTER_DATETIME_H
 
 #include "timefilter/filter.h"
+#include "timefilter/intern.h"
 
 namespace timefilter {
 
@@ -17,7 +18,7 @@ class DatetimeFilter : public Filter {
      DatetimeFilter(const Datetime& dt) : Filter(FilterType::Datetime), _dt(dt) { }
 
      static Pointer create(const Datetime& dt) {
-         return std::make_shared<DatetimeFilter>(dt);
+         return interned<DatetimeFilter>(dt);
      }
 
      std::optional<Range> next_range(const Datetime& dt) const override {
@@ -44,6 +45,17 @@ class DatetimeFilter : public Filter {
          return _dt.isoformat();
      }
 
+     // The same instant in another zone is another filter, as its
+     // dt() and repr() differ.
+     size_t _hash() const override {
+         return hash_combine(std::hash<std::string>()(_dt.zone().name()), instant_millis(_dt));
+     }
+
+     bool _equals(const Filter& other) const override {
+         const auto& filter = static_cast<const DatetimeFilter&>(other);
+         return _dt == filter._dt && _dt.zone().name() == filter._dt.zone().name();
+     }
+
  private:
      Range range(const Zone& zone) const {
          return Range(
@@ -20,7 +20,7 @@ class FilterDuration : public Filter {
      }
 
      static Pointer create(Pointer filter, const Duration& duration) {
-         return std::make_shared<FilterDuration>(filter, duration);
+         return make_filter<FilterDuration>(filter, duration);
      }
 
      std::optional<Range> next_range(const Datetime& dt) const override {
@@ -43,6 +43,58 @@ class FilterDuration : public Filter {
          return range;
      }
 
+     int64_t count(const Range& window) const override {
+         return _filter->count(window);
+     }
+
+     // Ranges only overlap if the duration outlasts the spacing of the
+     // underlying filter, and only then need to be walked and merged.
+     Duration coverage(const Range& window) const override {
+         auto spacing = _filter->min_spacing();
+
+         if (spacing.has_value() && _duration <= *spacing) {
+             return _fixed_length_coverage(window, _duration);
+         }
+
+         return Filter::coverage(window);
+     }
+
+     std::optional<Duration> cycle() const override {
+         return _filter->cycle();
+     }
+
+     bool follows_calendar() const override {
+         return _filter->follows_calendar();
+     }
+
+     bool never_matches() const override {
+         return _filter->never_matches();
+     }
+
+     std::optional<Duration> max_wait() const override {
+         return _filter->max_wait();
+     }
+
+     std::optional<Range> nth_next(const Datetime& dt, int64_t k) const override {
+         auto range = _filter->nth_next(dt, k);
+
+         if (range.has_value()) {
+             range = Range(range->start(), _duration);
+         }
+
+         return range;
+     }
+
+     std::optional<Range> nth_prev(const Datetime& dt, int64_t k) const override {
+         auto range = _filter->nth_prev(dt, k);
+
+         if (range.has_value()) {
+             range = Range(range->start(), _duration);
+         }
+
+         return range;
+     }
+
      Pointer filter() const {
          return _filter;
      }
@@ -58,6 +110,21 @@ class FilterDuration : public Filter {
          return sb.str();
      }
 
+     size_t _hash() const override {
+         return hash_combine(_filter->hash(), to_millis(_duration));
+     }
+
+     bool _equals(const Filter& other) const override {
+         const auto& filter = static_cast<const FilterDuration&>(other);
+         return _duration == filter._duration && _filter->equals(*filter._filter);
+     }
+
+     std::string _canonical() const override {
+         std::ostringstream sb;
+         sb << _filter->canonical() << " + " << _duration;
+         return sb.str();
+     }
+
  private:
      void validate() const {
          if (_duration <= Duration::zero()) {
@@ -0,0 +1,177 @@
+/*
+ * exclusion.h
+ *
+ * Author: Lain Musgrove (lain.proliant@gmail.com)
+ * Date: Sunday October 18, 2026
+ */
+
+#ifndef __TIMEFILTER_EXCLUSION_H
+#define __TIMEFILTER_EXCLUSION_H
+
+#include "timefilter/filter.h"
+#include "timefilter/holidays.h"
+
+namespace timefilter {
+
+// --------------------------------------------------------
+// Cuts holidays out of the ranges of the given filter.
+// Each range is split into its runs of days that aren't
+// holidays, so a range covering a holiday yields the parts
+// before and after it, and a range falling entirely on
+// holidays is dropped.  Runs of holidays are skipped at a
+// time.
+// --------------------------------------------------------
+class FilterExclusion : public Filter {
+ public:
+     FilterExclusion(Pointer filter, HolidaySet::Pointer holidays) :
+     Filter(FilterType::FilterExclusion), _filter(filter), _holidays(holidays) {
+         validate();
+     }
+
+     static Pointer create(Pointer filter, HolidaySet::Pointer holidays) {
+         return make_filter<FilterExclusion>(filter, holidays);
+     }
+
+     std::optional<Range> next_range(const Datetime& dt) const override {
+         Datetime pivot = dt;
+
+         for (;;) {
+             // The last range starting by the pivot may have a part
+             // after it, past a holiday.
+             auto range = _filter->prev_range(pivot);
+
+             if (range.has_value()) {
+                 auto part = next_part(*range, dt);
+                 if (part.has_value()) {
+                     return part;
+                 }
+             }
+
+             range = _filter->next_range(pivot);
+
+             if (! range.has_value()) {
+                 return {};
+             }
+
+             auto part = next_part(*range, dt);
+             if (part.has_value()) {
+                 return part;
+             }
+
+             const Date date = _holidays->skip_forward(range->start().date());
+             pivot = Datetime(dt.zone(), date) - Duration::of_millis(1);
+         }
+     }
+
+     std::optional<Range> prev_range(const Datetime& dt) const override {
+         Datetime pivot = dt;
+
+         for (;;) {
+             auto range = _filter->prev_range(pivot);
+
+             if (! range.has_value()) {
+                 return {};
+             }
+
+             auto part = prev_part(*range, dt);
+             if (part.has_value()) {
+                 return part;
+             }
+
+             const Date date = _holidays->skip_backward(range->start().date());
+             pivot = Datetime(dt.zone(), date.advance_days(1)) - Duration::of_millis(1);
+         }
+     }
+
+     Pointer filter() const {
+         return _filter;
+     }
+
+     HolidaySet::Pointer holidays() const {
+         return _holidays;
+     }
+
+ protected:
+     std::string _repr() const override {
+         std::ostringstream sb;
+         sb << _filter->repr() << " - " << _holidays->size() << " holidays";
+         return sb.str();
+     }
+
+     size_t _hash() const override {
+         return hash_combine(_filter->hash(), _holidays->hash());
+     }
+
+     bool _equals(const Filter& other) const override {
+         const auto& filter = static_cast<const FilterExclusion&>(other);
+         return *_holidays == *filter._holidays && _filter->equals(*filter._filter);
+     }
+
+     std::string _canonical() const override {
+         std::vector<std::string> dates;
+         for (const auto& date : _holidays->dates()) {
+             dates.push_back(date.isoformat());
+         }
+
+         std::ostringstream sb;
+         sb << _filter->canonical() << " - " << moonlight::str::join(dates, ",");
+         return sb.str();
+     }
+
+ private:
+     void validate() const {
+         if (_holidays == nullptr) {
+             THROW(Error, "A holiday set must be provided for FilterExclusion.");
+         }
+     }
+
+     // The part of `range` starting at `start`, or at the first day
+     // after it that isn't a holiday, up to the next holiday.
+     std::optional<Range> part_from(const Range& range, Datetime start) const {
+         const Date date = start.date();
+
+         if (_holidays->contains(date)) {
+             start = Datetime(start.zone(), _holidays->skip_forward(date));
+         }
+
+         if (start >= range.end()) {
+             return {};
+         }
+
+         auto holiday = _holidays->next_holiday(start.date());
+         if (holiday.has_value()) {
+             return Range(start, std::min(range.end(), Datetime(start.zone(), *holiday)));
+         }
+
+         return Range(start, range.end());
+     }
+
+     // The first part of `range` starting after `dt`.
+     std::optional<Range> next_part(const Range& range, const Datetime& dt) const {
+         for (auto part = part_from(range, range.start()); part.has_value(); part = part_from(range, part->end())) {
+             if (dt < part->start()) {
+                 return part;
+             }
+         }
+
+         return {};
+     }
+
+     // The last part of `range` starting at or before `dt`.
+     std::optional<Range> prev_part(const Range& range, const Datetime& dt) const {
+         std::optional<Range> result;
+
+         for (auto part = part_from(range, range.start()); part.has_value() && part->start() <= dt; part = part_from(range, part->end())) {
+             result = part;
+         }
+
+         return result;
+     }
+
+     Pointer _filter;
+     HolidaySet::Pointer _holidays;
+};
+
+}
+
+#endif /* !__TIMEFILTER_EXCLUSION_H */
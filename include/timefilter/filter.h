@@ -10,6 +10,11 @@
 
 #include "moonlight/exceptions.h"
 #include "moonlight/date.h"
+#include "moonlight/string.h"
+#include "timefilter/calendar.h"
+#include "timefilter/constants.h"
+#include "timefilter/hash.h"
+#include "timefilter/memory.h"
 
 namespace timefilter {
 
@@ -19,9 +24,14 @@ EXCEPTION_TYPE(Error);
 
 // --------------------------------------------------------
 enum class FilterType {
+    AbsoluteIndex,
+    BusinessDay,
+    BusinessDayOffset,
+    Cadence,
     Date,
     Datetime,
     Duration,
+    FilterExclusion,
     FilterList,
     FilterOffset,
     FilterSet,
@@ -43,6 +53,7 @@ inline bool operator<(FilterType lhs, FilterType rhs) {
 
 inline std::set<FilterType>& absolute_filter_types() {
     static std::set<FilterType> types = {
+        FilterType::AbsoluteIndex,
         FilterType::Date,
         FilterType::Datetime,
         FilterType::StaticRange,
@@ -53,7 +64,9 @@ inline std::set<FilterType>& absolute_filter_types() {
 
 inline std::set<FilterType>& relative_filter_types() {
     static std::set<FilterType> types = {
+        FilterType::BusinessDayOffset,
         FilterType::Duration,
+        FilterType::FilterExclusion,
         FilterType::FilterList,
         FilterType::FilterOffset,
         FilterType::FilterSet,
@@ -65,9 +78,14 @@ inline std::set<FilterType>& relative_filter_types() {
 inline const std::string& filter_type_name(FilterType type) {
     static std::string UNKNOWN = "???";
     static std::vector<std::string> names = {
+        "AbsoluteIndex",
+        "BusinessDay",
+        "BusinessDayOffset",
+        "Cadence",
         "Date",
         "Datetime",
         "Duration",
+        "FilterExclusion",
         "FilterList",
         "FilterOffset",
         "FilterSet",
@@ -90,10 +108,21 @@ inline const std::string& filter_type_name(FilterType type) {
     return names.at(offset);
 }
 
+// --------------------------------------------------------
+// How often a filter matches in the long run: the expected
+// number of ranges starting in a mean year, and the fraction
+// of all time they cover.
+// --------------------------------------------------------
+struct Density {
+    double per_year = 0.0;
+    double fraction = 0.0;
+};
+
 // --------------------------------------------------------
 class Filter : public std::enable_shared_from_this<Filter> {
  public:
      typedef std::shared_ptr<const Filter> Pointer;
+     typedef std::pmr::vector<Pointer> Vector;
 
      explicit Filter(FilterType type) : _type(type) { }
      virtual ~Filter() { }
@@ -125,6 +154,32 @@ class Filter : public std::enable_shared_from_this<Filter> {
          return filter_type_name(type());
      }
 
+     // A structural hash, the same for any filters which are equals().
+     size_t hash() const {
+         return hash_combine(_hash(), static_cast<uint64_t>(type()));
+     }
+
+     // Structural equality, where the order of the filters within
+     // lists and sets doesn't matter.
+     bool equals(const Filter& other) const {
+         return this == &other || (type() == other.type() && _equals(other));
+     }
+
+     // Like repr(), but the same for any filters which are equals().
+     std::string canonical() const {
+         std::ostringstream sb;
+
+         if (type() == FilterType::FilterList) {
+             sb << "[" << _canonical() <<  "]";
+         } else if (type() == FilterType::FilterSet) {
+             sb << "{" << _canonical() << "}";
+         } else {
+             sb << type_name() << "<" << _canonical() << ">";
+         }
+
+         return sb.str();
+     }
+
      friend std::ostream& operator<<(std::ostream& out, const Filter& filter) {
          if (filter.type() == FilterType::FilterList) {
              out << "[" << filter._repr() <<  "]";
@@ -148,15 +203,517 @@ class Filter : public std::enable_shared_from_this<Filter> {
          return shared_from_this();
      }
 
+     // Counts the ranges which start within the window.  Periodic
+     // filters override this with closed-form arithmetic.
+     virtual int64_t count(const Range& window) const {
+         int64_t n = 0;
+
+         for (auto rg = next_range(window.start() - Duration::of_millis(1));
+              rg.has_value() && rg->start() < window.end();
+              rg = next_range(rg->start())) {
+             n++;
+         }
+
+         return n;
+     }
+
+     // The total time within the window covered by at least one range.
+     // The default walks coalesced runs, so overlapping ranges are only
+     // counted once.
+     virtual Duration coverage(const Range& window) const {
+         int64_t total = 0;
+         auto run = prev_coalesced_range(window.start());
+
+         if (! run.has_value() || run->end() <= window.start()) {
+             run = next_coalesced_range(window.start());
+         }
+
+         for (; run.has_value() && run->start() < window.end(); run = next_coalesced_range(run->start())) {
+             total += to_millis(std::min(run->end(), window.end()) - std::max(run->start(), window.start()));
+         }
+
+         return Duration::of_millis(total);
+     }
+
+     // Calendar filters override this with closed forms.  The default
+     // samples count() and coverage() over years aligned to the weekday
+     // and leap year cycles.  Absolute filters match a bounded number
+     // of times, which is nothing in the long run.
+     virtual Density density() const {
+         if (is_absolute()) {
+             return {};
+         }
+
+         const Range sample(Datetime(DENSITY_SAMPLE_START_YEAR, Month::January, 1),
+                            Datetime(DENSITY_SAMPLE_START_YEAR + DENSITY_SAMPLE_YEARS, Month::January, 1));
+         const int64_t length = to_millis(sample.end() - sample.start());
+
+         return {
+             static_cast<double>(count(sample)) * MILLIS_PER_DAY * DAYS_PER_YEAR / length,
+             static_cast<double>(to_millis(coverage(sample))) / length
+         };
+     }
+
+     // A lower bound on the time between consecutive range starts,
+     // if the filter's structure provides one.
+     virtual std::optional<Duration> min_spacing() const {
+         return {};
+     }
+
+     // The wall-clock period after which the filter's ranges repeat,
+     // if they do.
+     virtual std::optional<Duration> cycle() const {
+         return {};
+     }
+
+     // True if the filter matches by calendar date and time of day
+     // alone, so that its ranges repeat wherever the calendar does.
+     virtual bool follows_calendar() const {
+         return false;
+     }
+
+     // The first and last days the filter matches within the given
+     // month, for filters whose ranges are whole days or months.
+     // Empty for filters which aren't aligned to days.
+     virtual std::optional<MonthDays> month_days(int year, Month month) const {
+         return {};
+     }
+
+     // True if the filter is proven never to produce a range.
+     virtual bool never_matches() const {
+         return false;
+     }
+
+     // An upper bound on the wait from any instant to the start of
+     // the next range, if one can be proven.  A repeating filter's
+     // next range always starts within one cycle.
+     virtual std::optional<Duration> max_wait() const {
+         if (never_matches()) {
+             return {};
+         }
+
+         return cycle();
+     }
+
+     // The kth range starting after `dt`, where the 1st is next_range(dt).
+     virtual std::optional<Range> nth_next(const Datetime& dt, int64_t k) const {
+         validate_nth(k);
+         auto range = next_range(dt);
+
+         for (int64_t x = 1; range.has_value() && x < k; x++) {
+             range = next_range(range->start());
+         }
+
+         return range;
+     }
+
+     // The kth range starting at or before `dt`, where the 1st is prev_range(dt).
+     virtual std::optional<Range> nth_prev(const Datetime& dt, int64_t k) const {
+         validate_nth(k);
+         auto range = prev_range(dt);
+
+         for (int64_t x = 1; range.has_value() && x < k; x++) {
+             range = prev_range(range->start() - Duration::of_millis(1));
+         }
+
+         return range;
+     }
+
+     // The first maximal run of contiguous ranges starting after `dt`.
+     // Filters which can tell adjacency from their own structure
+     // override this; the default compares neighboring ranges.  A
+     // filter which matches all the time has one endless run, which
+     // is never next.
+     virtual std::optional<Range> next_coalesced_range(const Datetime& dt) const {
+         auto range = next_range(dt);
+
+         if (! range.has_value()) {
+             return {};
+         }
+
+         // Skip the rest of a run which started at or before `dt`.
+         auto before = prev_range(range->start() - Duration::of_millis(1));
+
+         if (before.has_value() && before->end() >= range->start()) {
+             const Range run = _extend_run(*before);
+
+             if (run.end() == Datetime::max()) {
+                 return {};
+             }
+
+             range = next_range(run.end());
+
+             if (! range.has_value()) {
+                 return {};
+             }
+         }
+
+         const Range run = _extend_run(*range);
+
+         if (run.start() == Datetime::min()) {
+             return {};
+         }
+
+         return run;
+     }
+
+     // The last maximal run of contiguous ranges starting at or before `dt`.
+     virtual std::optional<Range> prev_coalesced_range(const Datetime& dt) const {
+         auto range = prev_range(dt);
+
+         if (! range.has_value()) {
+             return {};
+         }
+
+         const auto period = cycle();
+         const Datetime end = range->end();
+
+         for (int steps = 0; ; steps++) {
+             if (period.has_value() && end - range->start() >= *period) {
+                 return Range(Datetime::min(), Datetime::max());
+             }
+
+             if (steps >= COALESCE_STEP_LIMIT) {
+                 THROW(Error, "Filter could not find the start of a run within " + std::to_string(COALESCE_STEP_LIMIT) + " ranges.");
+             }
+
+             auto before = prev_range(range->start() - Duration::of_millis(1));
+
+             if (! before.has_value() || before->end() < range->start()) {
+                 break;
+             }
+
+             range = before;
+         }
+
+         return _extend_run(*range);
+     }
+
+     // The index of the range containing `dt` among the ranges starting
+     // at or after `epoch`, or a negative index if it starts before
+     // `epoch`.  Empty if no range contains `dt`.
+     std::optional<int64_t> ordinal(const Datetime& dt, const Datetime& epoch) const {
+         auto range = current_range(dt);
+
+         if (! range.has_value()) {
+             return {};
+         }
+
+         if (range->start() < epoch) {
+             return -count(Range(range->start(), epoch));
+         }
+
+         return count(Range(epoch, range->start()));
+     }
+
  protected:
      virtual std::string _repr() const {
          return "";
      }
 
+     // Filters whose repr doesn't describe them completely, or which
+     // have children, override these.
+     virtual size_t _hash() const {
+         return std::hash<std::string>()(_repr());
+     }
+
+     virtual bool _equals(const Filter& other) const {
+         return _repr() == other._repr();
+     }
+
+     virtual std::string _canonical() const {
+         return _repr();
+     }
+
+     // Hashes and compares filters as multisets, for lists and sets.
+     static size_t _unordered_hash(const Vector& filters) {
+         size_t sum = 0;
+
+         for (const auto& filter : filters) {
+             sum += hash_mix(filter->hash());
+         }
+
+         return hash_combine(sum, filters.size());
+     }
+
+     static bool _unordered_equals(const Vector& filtersA, const Vector& filtersB) {
+         if (filtersA.size() != filtersB.size()) {
+             return false;
+         }
+
+         std::vector<size_t> hashes;
+         std::vector<bool> matched(filtersB.size(), false);
+         std::transform(filtersB.begin(), filtersB.end(), std::back_inserter(hashes), [](const auto& filter) {
+             return filter->hash();
+         });
+
+         for (const auto& filter : filtersA) {
+             const size_t hash = filter->hash();
+             bool found = false;
+
+             for (size_t x = 0; x < filtersB.size() && ! found; x++) {
+                 if (! matched[x] && hashes[x] == hash && filter->equals(*filtersB[x])) {
+                     matched[x] = found = true;
+                 }
+             }
+
+             if (! found) {
+                 return false;
+             }
+         }
+
+         return true;
+     }
+
+     static std::string _unordered_canonical(const Vector& filters) {
+         std::vector<std::string> canonicals;
+         std::transform(filters.begin(), filters.end(), std::back_inserter(canonicals), [](const auto& filter) {
+             return filter->canonical();
+         });
+         std::sort(canonicals.begin(), canonicals.end());
+         return moonlight::str::join(canonicals, ",");
+     }
+
+     // Steps through the ranges of a run until one leaves a gap.  A run
+     // covering a whole period of the filter repeats with it, so it
+     // covers all of time.  A run of a filter without a period can't be
+     // told from an endless one, so past COALESCE_STEP_LIMIT ranges
+     // Error is thrown rather than stepping forever.
+     Range _extend_run(const Range& first) const {
+         const auto period = cycle();
+         Range last = first;
+         Datetime end = first.end();
+
+         for (int steps = 0; ; steps++) {
+             if (period.has_value() && end - first.start() >= *period) {
+                 return Range(Datetime::min(), Datetime::max());
+             }
+
+             if (steps >= COALESCE_STEP_LIMIT) {
+                 THROW(Error, "Filter could not find the end of a run within " + std::to_string(COALESCE_STEP_LIMIT) + " ranges.");
+             }
+
+             auto next = next_range(last.start());
+
+             if (! next.has_value() || next->start() > end) {
+                 break;
+             }
+
+             end = std::max(end, next->end());
+             last = *next;
+         }
+
+         return Range(first.start(), end);
+     }
+
+     // Finds a range for a pivot moved by whole periods to near the
+     // year 2000, then moves the range back, so that a repeating
+     // filter costs the same for a pivot in the year 9999 as for one
+     // today.  Pivots are only moved by whole Gregorian cycles, which
+     // keep their date and weekday and so the zone's daylight saving
+     // rules, and are moved as instants so that a repeated hour keeps
+     // its offset.  Where the zone's offsets differ across the move,
+     // as they do for its historical rules, the pivot is left as it
+     // is.  Ranges moved past either end of time are dropped.
+     template<class Find>
+     static std::optional<Range> _reduced_find(const Datetime& dt, const std::optional<Duration>& period, Find find) {
+         const int64_t local = local_millis(dt);
+         const int64_t anchor = CYCLE_ANCHOR_DAYS * MILLIS_PER_DAY;
+         const int64_t cycle_millis = DAYS_PER_CYCLE * MILLIS_PER_DAY;
+
+         if (! period.has_value() || std::abs(local - anchor) < cycle_millis) {
+             return find(dt);
+         }
+
+         const auto step = lcm_millis(to_millis(*period), cycle_millis);
+
+         if (! step.has_value()) {
+             return find(dt);
+         }
+
+         const int64_t shift = floor_div(local - anchor, *step) * *step;
+         const Datetime pivot = dt - Duration::of_millis(shift);
+
+         if (shift == 0 || local_millis(pivot) != local - shift) {
+             return find(dt);
+         }
+
+         auto range = find(pivot);
+
+         if (! range.has_value()) {
+             return {};
+         }
+
+         const int64_t min_millis = local_millis(Datetime::min());
+         const int64_t max_millis = local_millis(Datetime::max());
+         const int64_t start = local_millis(range->start()) + shift;
+         const int64_t end = local_millis(range->end()) + shift;
+
+         if (start > max_millis || end < min_millis) {
+             return {};
+         }
+
+         const Datetime range_start = start < min_millis ? from_local_millis(dt.zone(), min_millis) : range->start() + Duration::of_millis(shift);
+         const Datetime range_end = end > max_millis ? from_local_millis(dt.zone(), max_millis) : range->end() + Duration::of_millis(shift);
+
+         if ((start >= min_millis && local_millis(range_start) != start) ||
+             (end <= max_millis && local_millis(range_end) != end)) {
+             return find(dt);
+         }
+
+         return Range(range_start, range_end);
+     }
+
+     // The least common period of the given filters, if they all have one.
+     static std::optional<Duration> _common_period(const Vector& filters) {
+         if (filters.empty()) {
+             return {};
+         }
+
+         int64_t common = 1;
+
+         for (const auto& filter : filters) {
+             auto period = filter->cycle();
+             if (! period.has_value()) {
+                 return {};
+             }
+
+             auto lcm = lcm_millis(common, to_millis(*period));
+             if (! lcm.has_value()) {
+                 return {};
+             }
+             common = *lcm;
+         }
+
+         return Duration::of_millis(common);
+     }
+
+     // coverage() for filters whose ranges all have the given length and
+     // never overlap: only the ranges cut by either end of the window
+     // need to be looked at.
+     Duration _fixed_length_coverage(const Range& window, const Duration& length) const {
+         int64_t total = count(window) * to_millis(length);
+
+         auto front = prev_range(window.start() - Duration::of_millis(1));
+         if (front.has_value() && front->end() > window.start()) {
+             total += to_millis(std::min(front->end(), window.end()) - window.start());
+         }
+
+         auto back = prev_range(window.end() - Duration::of_millis(1));
+         if (back.has_value() && back->start() >= window.start() && back->end() > window.end()) {
+             total -= to_millis(back->end() - window.end());
+         }
+
+         return Duration::of_millis(total);
+     }
+
+     static void validate_nth(int64_t k) {
+         if (k < 1) {
+             THROW(Error, "The occurrence index k must be at least 1.");
+         }
+     }
+
+     // nth_next() for filters with a closed-form count(): gallop out to a
+     // window holding at least k starts, then bisect for the kth start.
+     std::optional<Range> _seek_nth_next(const Datetime& dt, int64_t k) const {
+         validate_nth(k);
+         const Datetime start = dt + Duration::of_millis(1);
+         int64_t span = MILLIS_PER_DAY;
+
+         while (count(Range(start, start + Duration::of_millis(span))) < k) {
+             if (! next_range(start + Duration::of_millis(span - 1)).has_value()) {
+                 return {};
+             }
+             span *= 2;
+         }
+
+         // count(start, start + lo) < k <= count(start, start + hi)
+         int64_t lo = 0;
+         int64_t hi = span;
+
+         while (hi - lo > 1) {
+             const int64_t mid = lo + (hi - lo) / 2;
+             if (count(Range(start, start + Duration::of_millis(mid))) < k) {
+                 lo = mid;
+             } else {
+                 hi = mid;
+             }
+         }
+
+         return next_range(start + Duration::of_millis(lo - 1));
+     }
+
+     // nth_prev() for filters with a closed-form count(), as above.
+     std::optional<Range> _seek_nth_prev(const Datetime& dt, int64_t k) const {
+         validate_nth(k);
+         const Datetime end = dt + Duration::of_millis(1);
+         int64_t span = MILLIS_PER_DAY;
+
+         while (count(Range(end - Duration::of_millis(span), end)) < k) {
+             if (! prev_range(end - Duration::of_millis(span + 1)).has_value()) {
+                 return {};
+             }
+             span *= 2;
+         }
+
+         // count(end - lo, end) < k <= count(end - hi, end)
+         int64_t lo = 0;
+         int64_t hi = span;
+
+         while (hi - lo > 1) {
+             const int64_t mid = lo + (hi - lo) / 2;
+             if (count(Range(end - Duration::of_millis(mid), end)) < k) {
+                 lo = mid;
+             } else {
+                 hi = mid;
+             }
+         }
+
+         return prev_range(end - Duration::of_millis(hi));
+     }
+
  private:
      const FilterType _type;
 };
 
+// --------------------------------------------------------
+// For unordered containers keyed by the structure of filters.
+struct FilterHash {
+    size_t operator()(const Filter::Pointer& filter) const {
+        return filter->hash();
+    }
+};
+
+struct FilterEqual {
+    bool operator()(const Filter::Pointer& filterA, const Filter::Pointer& filterB) const {
+        return filterA->equals(*filterB);
+    }
+};
+
+// --------------------------------------------------------
+inline int64_t count(const Filter::Pointer& filter, const Range& window) {
+    return filter->count(window);
+}
+
+inline Duration coverage(const Filter::Pointer& filter, const Range& window) {
+    return filter->coverage(window);
+}
+
+inline Density density(const Filter::Pointer& filter) {
+    return filter->density();
+}
+
+// The fraction of the window covered by the filter's ranges.
+inline double duty_cycle(const Filter::Pointer& filter, const Range& window) {
+    const int64_t length = to_millis(window.end() - window.start());
+
+    if (length <= 0) {
+        return 0.0;
+    }
+
+    return static_cast<double>(to_millis(filter->coverage(window))) / length;
+}
+
 }
 
 
@@ -0,0 +1,149 @@
+/*
+ * gap_stats.h
+ *
+ * Author: Lain Musgrove (lain.proliant@gmail.com)
+ * Date: Sunday October 18, 2026
+ */
+
+#ifndef __TIMEFILTER_GAP_STATS_H
+#define __TIMEFILTER_GAP_STATS_H
+
+#include "timefilter/filter.h"
+
+namespace timefilter {
+
+// --------------------------------------------------------
+// Statistics on the gaps between the starts of consecutive
+// ranges which start within a window.  `shortest` and
+// `longest` are the first pair of starts with the min and
+// max gaps.
+// --------------------------------------------------------
+struct GapStats {
+    int64_t gaps = 0;
+    Duration min = Duration::zero();
+    Duration max = Duration::zero();
+    Duration mean = Duration::zero();
+    Range shortest = Range(Datetime::min(), Datetime::min());
+    Range longest = Range(Datetime::min(), Datetime::min());
+};
+
+// Walks the ranges starting in [first, until], collecting
+// the min and max gaps between their starts.  Gaps already
+// `found` are only replaced by strictly shorter or longer ones.
+inline bool _scan_gaps(const Filter& filter, const Range& first, const Datetime& until, GapStats& stats, bool found = false) {
+    Range prev = first;
+
+    for (auto range = filter.next_range(prev.start());
+         range.has_value() && range->start() <= until;
+         range = filter.next_range(range->start())) {
+        const Duration gap = range->start() - prev.start();
+
+        if (! found || gap < stats.min) {
+            stats.min = gap;
+            stats.shortest = Range(prev.start(), range->start());
+        }
+
+        if (! found || gap > stats.max) {
+            stats.max = gap;
+            stats.longest = Range(prev.start(), range->start());
+        }
+
+        found = true;
+        prev = *range;
+    }
+
+    return found;
+}
+
+// The first March 1st after `dt` which follows a skipped leap day.
+inline Datetime _next_skipped_leap_day(const Datetime& dt) {
+    for (int64_t year = floor_div(dt.date().year(), 100) * 100; ; year += 100) {
+        if (floor_mod(year, 400) != 0) {
+            const Datetime march = Datetime(dt.zone(), Date(year, Month::March, 1));
+            if (march > dt) {
+                return march;
+            }
+        }
+    }
+}
+
+// Walks the gaps of a filter which follows the calendar.  Within
+// each stretch of the window between skipped leap days, the gaps
+// repeat every 28 years, so only the first 28 years of a stretch
+// are walked, along with the gaps across its ends.
+inline void _scan_calendar_gaps(const Filter& filter, const Range& first, const Range& last, GapStats& stats) {
+    const Duration solar_cycle = Duration::of_days(DAYS_PER_SOLAR_CYCLE);
+    const Duration one_ms = Duration::of_millis(1);
+    bool found = false;
+    Range from = first;
+    Datetime stretch = first.start();
+
+    for (;;) {
+        const Datetime boundary = _next_skipped_leap_day(stretch);
+        Datetime until = last.start();
+
+        for (const Datetime& edge : {stretch + solar_cycle, boundary}) {
+            auto range = filter.next_range(edge - one_ms);
+            if (range.has_value() && range->start() < until) {
+                until = range->start();
+            }
+        }
+
+        found = _scan_gaps(filter, from, until, stats, found);
+
+        if (until >= last.start()) {
+            return;
+        }
+
+        // Resume from the last range before the boundary, or where
+        // the walk stopped if that's later.
+        from = *filter.prev_range(std::max(until, boundary - one_ms));
+        stretch = boundary;
+    }
+}
+
+// The gaps between ranges starting within the window, or nothing if
+// fewer than two ranges start within it.  If the window spans at
+// least two periods of the filter, only the first period is walked,
+// since the gaps repeat after that.  Filters which follow the
+// calendar, such as months, days of the month and weekdays of the
+// month, only repeat with the 400 year Gregorian cycle, but between
+// skipped leap days the calendar repeats every 28 years, so shorter
+// windows of them are walked 28 years at a time.  Other filters
+// are walked range by range.
+inline std::optional<GapStats> gap_stats(const Filter::Pointer& filter, const Range& window) {
+    const int64_t n = filter->count(window);
+
+    if (n < 2) {
+        return {};
+    }
+
+    auto first = filter->next_range(window.start() - Duration::of_millis(1));
+    auto last = filter->prev_range(window.end() - Duration::of_millis(1));
+
+    if (! first.has_value() || ! last.has_value()) {
+        return {};
+    }
+
+    GapStats stats;
+    stats.gaps = n - 1;
+    stats.mean = Duration::of_millis(to_millis(last->start() - first->start()) / stats.gaps);
+
+    auto period = filter->cycle();
+
+    if (period.has_value() && window.end() - window.start() >= *period + *period) {
+        _scan_gaps(*filter, *first, first->start() + *period, stats);
+
+    } else if (filter->follows_calendar()) {
+        _scan_calendar_gaps(*filter, *first, *last, stats);
+
+    } else {
+        _scan_gaps(*filter, *first, last->start(), stats);
+    }
+
+    return stats;
+}
+
+}
+
+#endif /* !__TIMEFILTER_GAP_STATS_H */
@@ -0,0 +1,43 @@
+/*
+ * hash.h
+ *
+ * Author: Lain Musgrove (lain.proliant@gmail.com)
+ * Date: Sunday October 18, 2026
+ */
+
+#ifndef __TIMEFILTER_HASH_H
+#define __TIMEFILTER_HASH_H
+
+#include <cstdint>
+#include <functional>
+
+namespace timefilter {
+
+// --------------------------------------------------------
+// Hash mixing for the structural hashes of filters.
+// --------------------------------------------------------
+inline size_t hash_mix(uint64_t value) {
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdULL;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ULL;
+    value ^= value >> 33;
+    return static_cast<size_t>(value);
+}
+
+inline size_t hash_combine(size_t seed, uint64_t value) {
+    return seed ^ (hash_mix(value) + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+}
+
+// Combines the values of an ordered container, such as a std::set.
+template<class T>
+inline size_t hash_values(size_t seed, const T& values) {
+    for (const auto& value : values) {
+        seed = hash_combine(seed, static_cast<uint64_t>(value));
+    }
+    return hash_combine(seed, values.size());
+}
+
+}
+
+#endif /* !__TIMEFILTER_HASH_H */
@@ -0,0 +1,285 @@
+/*
+ * holidays.h
+ *
+ * Author: Lain Musgrove (lain.proliant@gmail.com)
+ * Date: Sunday October 18, 2026
+ */
+
+#ifndef __TIMEFILTER_HOLIDAYS_H
+#define __TIMEFILTER_HOLIDAYS_H
+
+#include <array>
+#include <bit>
+#include <fstream>
+#include "timefilter/calendar.h"
+#include "timefilter/filter.h"
+
+namespace timefilter {
+
+// --------------------------------------------------------
+// A set of dates stored as one day-of-year bitmap per year.
+// Membership is a single bit test and skipping over a run
+// of holidays is a bit scan.
+// --------------------------------------------------------
+class HolidaySet {
+ public:
+     typedef std::shared_ptr<const HolidaySet> Pointer;
+     typedef std::array<uint64_t, 6> YearBits;
+
+     HolidaySet() { }
+     HolidaySet(const std::set<Date>& dates) {
+         for (const auto& date : dates) {
+             add(date);
+         }
+     }
+
+     static Pointer create(const std::set<Date>& dates) {
+         return std::make_shared<HolidaySet>(dates);
+     }
+
+     // Reads one ISO date (YYYY-MM-DD) per line.  Blank lines and
+     // anything following a '#' are ignored.
+     static HolidaySet load(std::istream& infile) {
+         HolidaySet holidays;
+         std::string line;
+         int line_no = 0;
+
+         while (std::getline(infile, line)) {
+             line_no++;
+             line = line.substr(0, line.find('#'));
+             line.erase(std::remove_if(line.begin(), line.end(), ::isspace), line.end());
+
+             if (line.empty()) {
+                 continue;
+             }
+
+             int year, month, day;
+             char sepA, sepB;
+             std::istringstream sb(line);
+
+             if (! (sb >> year >> sepA >> month >> sepB >> day) || sepA != '-' || sepB != '-' || ! sb.eof()) {
+                 THROW(Error, "Invalid holiday date on line " + std::to_string(line_no) + ": " + line);
+             }
+
+             holidays.add(Date(year, month, day));
+         }
+
+         return holidays;
+     }
+
+     static Pointer load_file(const std::string& filename) {
+         std::ifstream infile(filename);
+
+         if (! infile) {
+             THROW(Error, "Could not open holiday file: " + filename);
+         }
+
+         return std::make_shared<HolidaySet>(load(infile));
+     }
+
+     void add(const Date& date) {
+         const int offset = day_of_year(date);
+         _years[date.year()][offset / 64] |= uint64_t(1) << (offset % 64);
+     }
+
+     bool contains(const Date& date) const {
+         auto iter = _years.find(date.year());
+
+         if (iter == _years.end()) {
+             return false;
+         }
+
+         const int offset = day_of_year(date);
+         return (iter->second[offset / 64] >> (offset % 64)) & 1;
+     }
+
+     bool empty() const {
+         return _years.empty();
+     }
+
+     size_t size() const {
+         size_t count = 0;
+
+         for (const auto& [year, bits] : _years) {
+             for (auto word : bits) {
+                 count += std::popcount(word);
+             }
+         }
+
+         return count;
+     }
+
+     std::vector<int> years() const {
+         std::vector<int> years;
+         for (const auto& [year, bits] : _years) {
+             years.push_back(year);
+         }
+         return years;
+     }
+
+     // Bit `day - 1` is set for each holiday in the given month.
+     uint32_t month_bits(int year, Month month) const {
+         auto iter = _years.find(year);
+
+         if (iter == _years.end()) {
+             return 0;
+         }
+
+         return extract_bits(iter->second, day_of_year(Date(year, month)), last_day_of_month(year, month));
+     }
+
+     // The first date on or after `date` that is not a holiday.
+     Date skip_forward(const Date& date) const {
+         int year = date.year();
+         int offset = day_of_year(date);
+         auto iter = _years.find(year);
+
+         while (iter != _years.end() && iter->first == year) {
+             auto free_offset = first_free(iter->second, offset, days_in_year(year));
+             if (free_offset.has_value()) {
+                 return date_from_epoch_days(year_start(year) + *free_offset);
+             }
+
+             iter++;
+             year++;
+             offset = 0;
+         }
+
+         return date_from_epoch_days(year_start(year) + offset);
+     }
+
+     // The last date on or before `date` that is not a holiday.
+     Date skip_backward(const Date& date) const {
+         int year = date.year();
+         int offset = day_of_year(date);
+         auto iter = _years.find(year);
+
+         while (iter != _years.end() && iter->first == year) {
+             auto free_offset = last_free(iter->second, offset);
+             if (free_offset.has_value()) {
+                 return date_from_epoch_days(year_start(year) + *free_offset);
+             }
+
+             iter = iter == _years.begin() ? _years.end() : std::prev(iter);
+             year--;
+             offset = days_in_year(year) - 1;
+         }
+
+         return date_from_epoch_days(year_start(year) + offset);
+     }
+
+     // The first holiday on or after `date`, if there is one.
+     std::optional<Date> next_holiday(const Date& date) const {
+         for (auto iter = _years.lower_bound(date.year()); iter != _years.end(); iter++) {
+             const int offset = iter->first == date.year() ? day_of_year(date) : 0;
+             auto holiday_offset = first_set(iter->second, offset);
+             if (holiday_offset.has_value()) {
+                 return date_from_epoch_days(year_start(iter->first) + *holiday_offset);
+             }
+         }
+
+         return {};
+     }
+
+     std::vector<Date> dates() const {
+         std::vector<Date> dates;
+
+         for (const auto& [year, bits] : _years) {
+             for (int offset = 0; offset < days_in_year(year); offset++) {
+                 if ((bits[offset / 64] >> (offset % 64)) & 1) {
+                     dates.push_back(date_from_epoch_days(year_start(year) + offset));
+                 }
+             }
+         }
+
+         return dates;
+     }
+
+     size_t hash() const {
+         size_t hash = 0;
+
+         for (const auto& [year, bits] : _years) {
+             hash = hash_values(hash_combine(hash, year), bits);
+         }
+
+         return hash;
+     }
+
+     bool operator==(const HolidaySet& other) const {
+         return _years == other._years;
+     }
+
+ private:
+     static int64_t year_start(int year) {
+         return epoch_days(year, Month::January, 1);
+     }
+
+     static int days_in_year(int year) {
+         return is_leap_year(year) ? 366 : 365;
+     }
+
+     static int day_of_year(const Date& date) {
+         return static_cast<int>(epoch_days(date) - year_start(date.year()));
+     }
+
+     static std::optional<int> first_free(const YearBits& bits, int offset, int days) {
+         for (int word = offset / 64; word * 64 < days; word++) {
+             uint64_t free_bits = ~bits[word];
+             if (word == offset / 64) {
+                 free_bits &= ~uint64_t(0) << (offset % 64);
+             }
+             if (free_bits != 0) {
+                 const int free_offset = word * 64 + std::countr_zero(free_bits);
+                 return free_offset < days ? std::optional<int>(free_offset) : std::nullopt;
+             }
+         }
+
+         return {};
+     }
+
+     static std::optional<int> first_set(const YearBits& bits, int offset) {
+         for (int word = offset / 64; word < static_cast<int>(bits.size()); word++) {
+             uint64_t set_bits = bits[word];
+             if (word == offset / 64) {
+                 set_bits &= ~uint64_t(0) << (offset % 64);
+             }
+             if (set_bits != 0) {
+                 return word * 64 + std::countr_zero(set_bits);
+             }
+         }
+
+         return {};
+     }
+
+     static std::optional<int> last_free(const YearBits& bits, int offset) {
+         for (int word = offset / 64; word >= 0; word--) {
+             uint64_t free_bits = ~bits[word];
+             if (word == offset / 64 && offset % 64 != 63) {
+                 free_bits &= (uint64_t(1) << (offset % 64 + 1)) - 1;
+             }
+             if (free_bits != 0) {
+                 return word * 64 + 63 - std::countl_zero(free_bits);
+             }
+         }
+
+         return {};
+     }
+
+     static uint32_t extract_bits(const YearBits& bits, int offset, int count) {
+         const int word = offset / 64;
+         const int shift = offset % 64;
+         uint64_t value = bits[word] >> shift;
+
+         if (shift > 0 && word + 1 < static_cast<int>(bits.size())) {
+             value |= bits[word + 1] << (64 - shift);
+         }
+
+         return static_cast<uint32_t>(value & ((uint64_t(1) << count) - 1));
+     }
+
+     std::map<int, YearBits> _years;
+};
+
+}
+
+#endif /* !__TIMEFILTER_HOLIDAYS_H */
@@ -0,0 +1,103 @@
+/*
+ * intern.h
+ *
+ * Author: Lain Musgrove (lain.proliant@gmail.com)
+ * Date: Sunday October 18, 2026
+ */
+
+#ifndef __TIMEFILTER_INTERN_H
+#define __TIMEFILTER_INTERN_H
+
+#include <array>
+#include <mutex>
+#include <unordered_map>
+#include "timefilter/constants.h"
+#include "timefilter/filter.h"
+
+namespace timefilter {
+
+// --------------------------------------------------------
+// A process-wide table of immutable filter nodes, so that
+// structurally identical leaf filters created anywhere
+// share one node.  The table only holds weak references,
+// so nodes are freed once no filter uses them.  Lookups
+// are spread over independently locked shards by hash.
+// --------------------------------------------------------
+class FilterInterner {
+ public:
+     static FilterInterner& global() {
+         static FilterInterner interner;
+         return interner;
+     }
+
+     // The live node equal to `filter` if there is one, otherwise
+     // `filter`, which is added to the table.
+     Filter::Pointer intern(Filter::Pointer filter) {
+         const size_t hash = filter->hash();
+         Shard& shard = _shards[hash % INTERN_SHARDS];
+         std::lock_guard<std::mutex> lock(shard.mutex);
+         auto [begin, end] = shard.nodes.equal_range(hash);
+
+         for (auto iter = begin; iter != end; iter++) {
+             auto node = iter->second.lock();
+
+             if (node != nullptr && node->equals(*filter)) {
+                 return node;
+             }
+         }
+
+         if (shard.nodes.size() >= shard.sweep_at) {
+             sweep(shard);
+         }
+
+         shard.nodes.emplace(hash, filter);
+         return filter;
+     }
+
+     // The number of interned nodes still in use.
+     size_t size() {
+         size_t n = 0;
+
+         for (auto& shard : _shards) {
+             std::lock_guard<std::mutex> lock(shard.mutex);
+             for (const auto& [hash, node] : shard.nodes) {
+                 n += ! node.expired();
+             }
+         }
+
+         return n;
+     }
+
+ private:
+     struct Shard {
+         std::mutex mutex;
+         std::unordered_multimap<size_t, std::weak_ptr<const Filter>> nodes;
+         size_t sweep_at = INTERN_SWEEP_MIN;
+     };
+
+     // Drops the nodes which have been freed, and waits for the table
+     // to double before sweeping again.
+     static void sweep(Shard& shard) {
+         std::erase_if(shard.nodes, [](const auto& entry) {
+             return entry.second.expired();
+         });
+         shard.sweep_at = std::max(INTERN_SWEEP_MIN, shard.nodes.size() * 2);
+     }
+
+     std::array<Shard, INTERN_SHARDS> _shards;
+};
+
+// Creates a leaf filter, sharing the node of an identical live filter
+// unless a MemoryScope is active.
+template<class T, class... Args>
+inline Filter::Pointer interned(Args&&... args) {
+    if (MemoryScope::active() != nullptr) {
+        return make_filter<T>(std::forward<Args>(args)...);
+    }
+
+    return FilterInterner::global().intern(std::make_shared<T>(std::forward<Args>(args)...));
+}
+
+}
+
+#endif /* !__TIMEFILTER_INTERN_H */
@@ -8,7 +8,11 @@
 #ifndef __TIMEFILTER_LIST_H
 #define __TIMEFILTER_LIST_H
 
+#include <map>
+#include <unordered_set>
+#include "timefilter/absolute_index.h"
 #include "timefilter/filter.h"
+#include "timefilter/set.h"
 
 namespace timefilter {
 
@@ -16,15 +20,15 @@ class FilterList : public Filter {
  public:
      typedef std::shared_ptr<FilterList> Pointer;
 
-     FilterList() : Filter(FilterType::FilterList) { }
-     FilterList(Pointer list) : Filter(FilterType::FilterList), _filters(list->_filters) { }
+     FilterList() : Filter(FilterType::FilterList), _filters(MemoryScope::resource()) { }
+     FilterList(Pointer list) : Filter(FilterType::FilterList), _filters(list->_filters, MemoryScope::resource()), _period(list->_period) { }
 
      static Pointer create() {
-         return std::make_shared<FilterList>();
+         return make_filter<FilterList>();
      }
 
      static Pointer create(Pointer list) {
-         return std::make_shared<FilterList>(list);
+         return make_filter<FilterList>(list);
      }
 
      bool empty() const {
@@ -35,8 +39,13 @@ class FilterList : public Filter {
          return _filters.size();
      }
 
+     const Filter::Vector& filters() const {
+         return _filters;
+     }
+
      Pointer push(Filter::Pointer filter) {
          _filters.push_back(filter);
+         _add_period(*filter);
          return std::static_pointer_cast<FilterList>(shared_from_this());
      }
 
@@ -47,58 +56,127 @@ class FilterList : public Filter {
 
          auto filter = _filters.back();
          _filters.pop_back();
+         _period = _common_period(_filters);
          return filter;
      }
 
      std::optional<Range> next_range(const Datetime& dt) const override {
-         std::vector<Range> ranges;
+         return _reduced_find(dt, cycle(), [&](const Datetime& pivot) {
+             std::optional<Range> result;
 
-         for (auto filter : _filters) {
-             auto rg = filter->next_range(dt);
-             if (rg.has_value()) {
-                 ranges.push_back(rg.value());
+             for (const auto& filter : _filters) {
+                 auto rg = filter->next_range(pivot);
+                 if (rg.has_value() && (! result.has_value() || rg->start() < result->start())) {
+                     result = rg;
+                 }
              }
-         }
-
-         if (ranges.size() == 0) {
-             return {};
-         }
 
-         std::sort(ranges.begin(), ranges.end(), [](auto& rgA, auto& rgB) {
-             return rgA.start() < rgB.start();
+             return result;
          });
-
-         return ranges.front();
      }
 
      std::optional<Range> prev_range(const Datetime& dt) const override {
-         std::vector<Range> ranges;
+         return _reduced_find(dt, cycle(), [&](const Datetime& pivot) {
+             std::optional<Range> result;
 
-         for (auto filter : _filters) {
-             auto rg = filter->prev_range(dt);
-             if (rg.has_value()) {
-                 ranges.push_back(rg.value());
+             for (const auto& filter : _filters) {
+                 auto rg = filter->prev_range(pivot);
+                 if (rg.has_value() && (! result.has_value() || rg->start() >= result->start())) {
+                     result = rg;
+                 }
              }
+
+             return result;
+         });
+     }
+
+     // Branches can share a start, as "Mon, 1st" does on a Monday the
+     // 1st, which is one range of the list.  Branches starting at
+     // different times of day never do, so branches are grouped by the
+     // times they share and a branch alone in its group is counted in
+     // closed form.  Groups of branches which may share starts, and
+     // lists with branches whose start times aren't known, are stepped
+     // through by _step_count(), which is linear in the window or in
+     // the list's period, whichever is shorter.
+     int64_t count(const Range& window) const override {
+         auto groups = start_groups();
+
+         if (! groups.has_value()) {
+             return _step_count(window);
          }
 
-         if (ranges.size() == 0) {
-             return {};
+         int64_t n = 0;
+
+         for (const auto& group : *groups) {
+             if (group.size() == 1) {
+                 n += group.front()->count(window);
+                 continue;
+             }
+
+             auto list = FilterList::create();
+             for (const auto& filter : group) {
+                 list->push(filter);
+             }
+             n += list->_step_count(window);
          }
 
-         std::sort(ranges.begin(), ranges.end(), [](auto& rgA, auto& rgB) {
-             return rgA.start() < rgB.start();
+         return n;
+     }
+
+     // Kept as branches are pushed and popped, as every next_range()
+     // and prev_range() reads it.
+     std::optional<Duration> cycle() const override {
+         return _period;
+     }
+
+     bool follows_calendar() const override {
+         return ! _filters.empty() && std::all_of(_filters.begin(), _filters.end(), [](const auto& filter) {
+             return filter->follows_calendar();
          });
+     }
+
+     bool never_matches() const override {
+         return std::all_of(_filters.begin(), _filters.end(), [](const auto& filter) {
+             return filter->never_matches();
+         });
+     }
 
-         return ranges.back();
+     // The next range of the list is the first of any branch's.
+     std::optional<Duration> max_wait() const override {
+         std::optional<Duration> wait;
+
+         for (const auto& filter : _filters) {
+             auto filter_wait = filter->max_wait();
+             if (filter_wait.has_value() && (! wait.has_value() || *filter_wait < *wait)) {
+                 wait = filter_wait;
+             }
+         }
+
+         return wait;
      }
 
+     // Rewrites the list into fewer nodes: nested lists are flattened,
+     // sibling filters of the same kind are merged into one, sets which
+     // differ in a single such filter are folded together and duplicate
+     // branches are dropped.  Long runs of absolute filters are indexed.
      Filter::Pointer simplify() const override {
          auto list = FilterList::create();
 
-         for (auto filter : _filters) {
-             list->push(filter->simplify());
+         for (const auto& filter : _filters) {
+             auto simple = filter->simplify();
+
+             if (simple->type() == FilterType::FilterList) {
+                 const auto& nested = std::static_pointer_cast<const FilterList>(simple)->_filters;
+                 std::copy(nested.begin(), nested.end(), std::back_inserter(list->_filters));
+
+             } else {
+                 list->push(simple);
+             }
          }
 
+         list->_filters = index_absolutes(remove_duplicates(fold_sets(merge_siblings(remove_duplicates(list->_filters)))));
+         list->_period = _common_period(list->_filters);
+
          if (list->_filters.size() == 1) {
              return list->_filters.at(0);
          }
@@ -109,14 +187,344 @@ class FilterList : public Filter {
  protected:
      std::string _repr() const override {
          std::vector<std::string> reprs;
-         std::transform(_filters.begin(), _filters.end(), std::back_inserter(reprs), [](auto filter) {
+         std::transform(_filters.begin(), _filters.end(), std::back_inserter(reprs), [](const auto& filter) {
              return filter->repr();
          });
          return moonlight::str::join(reprs, ",");
      }
 
+     size_t _hash() const override {
+         return _unordered_hash(_filters);
+     }
+
+     bool _equals(const Filter& other) const override {
+         const auto& filter = static_cast<const FilterList&>(other);
+         return _unordered_equals(_filters, filter._filters);
+     }
+
+     std::string _canonical() const override {
+         return _unordered_canonical(_filters);
+     }
+
  private:
-     std::vector<Filter::Pointer> _filters;
+     static const std::set<FilterType>& mergeable_types() {
+         static const std::set<FilterType> types = {
+             FilterType::Month, FilterType::Monthday, FilterType::Time, FilterType::Weekday
+         };
+         return types;
+     }
+
+     // The union of filters of the same mergeable type, whose ranges
+     // are the ranges of any of them.
+     static Filter::Pointer merge(const Filter::Vector& filters) {
+         if (filters.size() == 1) {
+             return filters.front();
+         }
+
+         switch (filters.front()->type()) {
+         case FilterType::Month: {
+             std::set<Month> months;
+             for (const auto& filter : filters) {
+                 const auto& filter_months = static_cast<const MonthFilter&>(*filter).months();
+                 months.insert(filter_months.begin(), filter_months.end());
+             }
+             return MonthFilter::create(months);
+         }
+
+         case FilterType::Monthday: {
+             std::set<int> days;
+             for (const auto& filter : filters) {
+                 const auto& filter_days = static_cast<const MonthdayFilter&>(*filter).days();
+                 days.insert(filter_days.begin(), filter_days.end());
+             }
+             return MonthdayFilter::create(days);
+         }
+
+         case FilterType::Time: {
+             std::set<Time> times;
+             for (const auto& filter : filters) {
+                 const auto& filter_times = static_cast<const TimeFilter&>(*filter).times();
+                 times.insert(filter_times.begin(), filter_times.end());
+             }
+             return TimeFilter::create(times);
+         }
+
+         case FilterType::Weekday: {
+             std::set<Weekday> weekdays;
+             for (const auto& filter : filters) {
+                 const auto& filter_weekdays = static_cast<const WeekdayFilter&>(*filter).weekdays();
+                 weekdays.insert(filter_weekdays.begin(), filter_weekdays.end());
+             }
+             return WeekdayFilter::create(weekdays);
+         }
+
+         default:
+             THROW(Error, "Filters of type " + filters.front()->type_name() + " can't be merged.");
+         }
+     }
+
+     // The times of day a filter's ranges start at, if they're known.
+     // Filters matching whole days start at midnight.
+     static std::optional<std::set<Time>> start_times(const Filter& filter) {
+         if (filter.type() == FilterType::Time) {
+             return static_cast<const TimeFilter&>(filter).times();
+         }
+
+         if (matches_days(filter)) {
+             return std::set{Time(0, 0)};
+         }
+
+         if (filter.type() != FilterType::FilterSet) {
+             return {};
+         }
+
+         std::set<Time> times = {Time(0, 0)};
+
+         for (const auto& set_filter : static_cast<const FilterSet&>(filter).filters()) {
+             if (set_filter->type() == FilterType::Time) {
+                 times = static_cast<const TimeFilter&>(*set_filter).times();
+
+             } else if (! matches_days(*set_filter)) {
+                 return {};
+             }
+         }
+
+         return times;
+     }
+
+     static bool matches_days(const Filter& filter) {
+         switch (filter.type()) {
+         case FilterType::BusinessDay:
+         case FilterType::Date:
+         case FilterType::Month:
+         case FilterType::Monthday:
+         case FilterType::Weekday:
+         case FilterType::WeekdayMonthday:
+         case FilterType::WeekdayOfMonth:
+         case FilterType::Year:
+             return true;
+
+         default:
+             return false;
+         }
+     }
+
+     // Branches grouped so that no two groups share a start time,
+     // if the start times of every branch are known.
+     std::optional<std::vector<Filter::Vector>> start_groups() const {
+         std::vector<std::pair<std::set<Time>, Filter::Vector>> groups;
+
+         for (const auto& filter : _filters) {
+             auto times = start_times(*filter);
+
+             if (! times.has_value()) {
+                 return {};
+             }
+
+             std::pair<std::set<Time>, Filter::Vector> group(*times, Filter::Vector({filter}, MemoryScope::resource()));
+
+             for (auto iter = groups.begin(); iter != groups.end(); ) {
+                 if (std::any_of(times->begin(), times->end(), [&](const Time& time) { return iter->first.contains(time); })) {
+                     group.first.insert(iter->first.begin(), iter->first.end());
+                     group.second.insert(group.second.begin(), iter->second.begin(), iter->second.end());
+                     iter = groups.erase(iter);
+                 } else {
+                     iter++;
+                 }
+             }
+
+             groups.push_back(std::move(group));
+         }
+
+         std::vector<Filter::Vector> results;
+         for (auto& group : groups) {
+             results.push_back(std::move(group.second));
+         }
+         return results;
+     }
+
+     // Steps through the starts for one period of the list, which then
+     // repeats across the rest of the window.
+     int64_t _step_count(const Range& window) const {
+         const auto period = cycle();
+         const int64_t length = to_millis(window.end() - window.start());
+
+         if (! period.has_value() || length < 2 * to_millis(*period)) {
+             return Filter::count(window);
+         }
+
+         const int64_t periods = length / to_millis(*period);
+         const Datetime rest = window.start() + Duration::of_millis(periods * to_millis(*period));
+         return periods * Filter::count(Range(window.start(), window.start() + *period))
+             + Filter::count(Range(rest, window.end()));
+     }
+
+     void _add_period(const Filter& filter) {
+         const auto period = filter.cycle();
+
+         if (_filters.size() == 1) {
+             _period = period;
+             return;
+         }
+
+         if (! _period.has_value() || ! period.has_value()) {
+             _period = {};
+             return;
+         }
+
+         auto lcm = lcm_millis(to_millis(*_period), to_millis(*period));
+         _period = lcm.has_value() ? std::optional<Duration>(Duration::of_millis(*lcm)) : std::nullopt;
+     }
+
+     static Filter::Vector remove_duplicates(const Filter::Vector& filters) {
+         Filter::Vector results(MemoryScope::resource());
+         std::unordered_set<Filter::Pointer, FilterHash, FilterEqual> seen;
+
+         for (const auto& filter : filters) {
+             if (seen.insert(filter).second) {
+                 results.push_back(filter);
+             }
+         }
+
+         return results;
+     }
+
+     // Each kind is merged once, in the place of its first filter.
+     static Filter::Vector merge_siblings(const Filter::Vector& filters) {
+         Filter::Vector results(MemoryScope::resource());
+         std::map<FilterType, std::pair<size_t, Filter::Vector>> merged;
+
+         for (const auto& filter : filters) {
+             if (! mergeable_types().contains(filter->type())) {
+                 results.push_back(filter);
+                 continue;
+             }
+
+             auto iter = merged.find(filter->type());
+
+             if (iter == merged.end()) {
+                 merged.try_emplace(filter->type(), results.size(), Filter::Vector({filter}, MemoryScope::resource()));
+                 results.push_back(filter);
+
+             } else {
+                 iter->second.second.push_back(filter);
+             }
+         }
+
+         for (const auto& [type, group] : merged) {
+             results[group.first] = merge(group.second);
+         }
+
+         return results;
+     }
+
+     // Sets are folded together when all of their filters are the
+     // same except for one of the given type, e.g. "Mon 9:00, Tue 9:00"
+     // becomes "Mon,Tue 9:00".  The key identifies the other filters.
+     static std::optional<std::string> fold_key(const FilterSet& set, FilterType type) {
+         std::vector<std::string> reprs;
+         bool has_type = false;
+
+         for (const auto& filter : set.filters()) {
+             if (filter->type() == type) {
+                 has_type = true;
+             } else {
+                 reprs.push_back(filter->canonical());
+             }
+         }
+
+         if (! has_type) {
+             return {};
+         }
+
+         std::sort(reprs.begin(), reprs.end());
+         return moonlight::str::join(reprs, ",");
+     }
+
+     // Folds the filters of the given type from `others` into `set`.
+     static Filter::Pointer fold(const FilterSet& set, const Filter::Vector& others, FilterType type) {
+         Filter::Vector filters(set.filters(), MemoryScope::resource());
+
+         for (const auto& other : others) {
+             for (const auto& filter : static_cast<const FilterSet&>(*other).filters()) {
+                 if (filter->type() == type) {
+                     filters.push_back(filter);
+                 }
+             }
+         }
+
+         return FilterSet::create()->add(filters)->strategy(set.strategy());
+     }
+
+     // Moves the absolute filters into one sorted AbsoluteIndexFilter
+     // once there are enough of them that searching beats asking each.
+     static Filter::Vector index_absolutes(const Filter::Vector& filters) {
+         Filter::Vector results(MemoryScope::resource());
+         Filter::Vector absolutes(MemoryScope::resource());
+         size_t entries = 0;
+
+         for (const auto& filter : filters) {
+             if (AbsoluteIndexFilter::indexable(*filter)) {
+                 absolutes.push_back(filter);
+                 entries += filter->type() == FilterType::AbsoluteIndex
+                     ? static_cast<const AbsoluteIndexFilter&>(*filter).size() : 1;
+
+             } else {
+                 results.push_back(filter);
+             }
+         }
+
+         if (entries < ABSOLUTE_INDEX_MIN) {
+             return Filter::Vector(filters, MemoryScope::resource());
+         }
+
+         results.push_back(AbsoluteIndexFilter::create(absolutes));
+         return results;
+     }
+
+     static Filter::Vector fold_sets(const Filter::Vector& filters) {
+         Filter::Vector results(filters, MemoryScope::resource());
+
+         for (auto type : mergeable_types()) {
+             Filter::Vector folded(MemoryScope::resource());
+             std::map<std::string, size_t> keys;
+             std::map<size_t, Filter::Vector> others;
+
+             for (const auto& filter : results) {
+                 std::optional<std::string> key;
+
+                 if (filter->type() == FilterType::FilterSet) {
+                     key = fold_key(static_cast<const FilterSet&>(*filter), type);
+                 }
+
+                 if (! key.has_value()) {
+                     folded.push_back(filter);
+                     continue;
+                 }
+
+                 auto iter = keys.find(*key);
+
+                 if (iter == keys.end()) {
+                     keys.insert({*key, folded.size()});
+                     folded.push_back(filter);
+
+                 } else {
+                     others.try_emplace(iter->second, MemoryScope::resource()).first->second.push_back(filter);
+                 }
+             }
+
+             for (const auto& [index, sets] : others) {
+                 folded[index] = fold(static_cast<const FilterSet&>(*folded[index]), sets, type);
+             }
+
+             results = folded;
+         }
+
+         return results;
+     }
+
+     Filter::Vector _filters;
+     std::optional<Duration> _period = {};
 };
 
 }
@@ -0,0 +1,75 @@
+/*
+ * memory.h
+ *
+ * Author: Lain Musgrove (lain.proliant@gmail.com)
+ * Date: Sunday October 18, 2026
+ */
+
+#ifndef __TIMEFILTER_MEMORY_H
+#define __TIMEFILTER_MEMORY_H
+
+#include <memory>
+#include <memory_resource>
+
+namespace timefilter {
+
+// --------------------------------------------------------
+// Routes the allocations of filters created on this thread
+// to a memory resource for the lifetime of the scope, e.g.
+// a std::pmr::monotonic_buffer_resource serving one whole
+// compile-and-evaluate request.  Every filter created in
+// the scope must be destroyed before the resource is.
+// Filters created in a scope are never interned, since
+// interned nodes can outlive it.
+//
+// The scope holds filter nodes, their control blocks and
+// the filter vectors of sets and lists.  The containers
+// leaf filters keep their own values in, such as the days,
+// months, times and holidays they match, are std::sets
+// and still come from the heap.
+// --------------------------------------------------------
+class MemoryScope {
+ public:
+     explicit MemoryScope(std::pmr::memory_resource* resource) : _prev(active()) {
+         active() = resource;
+     }
+
+     ~MemoryScope() {
+         active() = _prev;
+     }
+
+     MemoryScope(const MemoryScope&) = delete;
+     MemoryScope& operator=(const MemoryScope&) = delete;
+
+     // The resource of the innermost scope on this thread, if any.
+     static std::pmr::memory_resource*& active() {
+         static thread_local std::pmr::memory_resource* resource = nullptr;
+         return resource;
+     }
+
+     // The resource of the innermost scope, or the default resource.
+     static std::pmr::memory_resource* resource() {
+         auto resource = active();
+         return resource != nullptr ? resource : std::pmr::get_default_resource();
+     }
+
+ private:
+     std::pmr::memory_resource* const _prev;
+};
+
+// Allocates a filter node from the active scope's resource, or
+// from the heap outside of any scope.
+template<class T, class... Args>
+inline std::shared_ptr<T> make_filter(Args&&... args) {
+    auto resource = MemoryScope::active();
+
+    if (resource != nullptr) {
+        return std::allocate_shared<T>(std::pmr::polymorphic_allocator<T>(resource), std::forward<Args>(args)...);
+    }
+
+    return std::make_shared<T>(std::forward<Args>(args)...);
+}
+
+}
+
+#endif /* !__TIMEFILTER_MEMORY_H */
@@ -8,7 +8,10 @@
 #ifndef __TIMEFILTER_MONTH_H
 #define __TIMEFILTER_MONTH_H
 
+#include "timefilter/calendar.h"
 #include "timefilter/filter.h"
+#include "timefilter/intern.h"
+#include "timefilter/runs.h"
 
 namespace timefilter {
 
@@ -18,19 +21,19 @@ class MonthFilter : public Filter {
      MonthFilter(const std::set<Month>& months) : Filter(FilterType::Month), _months(months) { }
 
      static Pointer create(Month month) {
-         return std::make_shared<MonthFilter>(month);
+         return interned<MonthFilter>(month);
      }
 
      static Pointer create(const std::set<Month>& months) {
-         return std::make_shared<MonthFilter>(months);
+         return interned<MonthFilter>(months);
      }
 
      std::optional<Range> next_range(const Datetime& dt) const override {
          for (int year = dt.date().year(); year - dt.date().year() <= 1; year ++) {
-             auto ranges = month_ranges(dt.zone(), year);
-             for (auto iter = ranges.begin(); iter != ranges.end(); iter++) {
-                 if (dt < iter->start()) {
-                     return *iter;
+             for (auto iter = _months.begin(); iter != _months.end(); iter++) {
+                 auto range = month_range(dt.zone(), year, *iter);
+                 if (dt < range.start()) {
+                     return range;
                  }
              }
          }
@@ -40,10 +43,10 @@ class MonthFilter : public Filter {
 
      std::optional<Range> prev_range(const Datetime& dt) const override {
          for (int year = dt.date().year(); dt.date().year() - year <= 1; year --) {
-             auto ranges = month_ranges(dt.zone(), year);
-             for (auto iter = ranges.rbegin(); iter != ranges.rend(); iter++) {
-                 if (dt >= iter->start()) {
-                     return *iter;
+             for (auto iter = _months.rbegin(); iter != _months.rend(); iter++) {
+                 auto range = month_range(dt.zone(), year, *iter);
+                 if (dt >= range.start()) {
+                     return range;
                  }
              }
          }
@@ -51,6 +54,121 @@ class MonthFilter : public Filter {
          THROW(Error, "Month filter could not find a prev range.");
      }
 
+     int64_t count(const Range& window) const override {
+         const int64_t first_month = first_month_at_or_after(window.start());
+         const int64_t end_month = first_month_at_or_after(window.end().zone(window.start().zone()));
+         int64_t n = 0;
+
+         for (auto month : _months) {
+             n += count_congruent(first_month, end_month, static_cast<int64_t>(month), 12);
+         }
+
+         return n;
+     }
+
+     std::optional<Duration> cycle() const override {
+         return Duration::of_days(DAYS_PER_CYCLE);
+     }
+
+     bool follows_calendar() const override {
+         return true;
+     }
+
+     std::optional<MonthDays> month_days(int year, Month month) const override {
+         if (_months.contains(month)) {
+             return MonthDays{1, last_day_of_month(year, month)};
+         }
+
+         return MonthDays{};
+     }
+
+     std::optional<Range> nth_next(const Datetime& dt, int64_t k) const override {
+         return _seek_nth_next(dt, k);
+     }
+
+     std::optional<Range> nth_prev(const Datetime& dt, int64_t k) const override {
+         return _seek_nth_prev(dt, k);
+     }
+
+     Density density() const override {
+         double days = 0.0;
+
+         for (auto month : _months) {
+             for_each_month_length(month, [&](int last_day, double share) {
+                 days += last_day * share;
+             });
+         }
+
+         return {static_cast<double>(_months.size()), days / DAYS_PER_YEAR};
+     }
+
+     Duration coverage(const Range& window) const override {
+         const Zone& zone = window.start().zone();
+         const Datetime end = window.end().zone(zone);
+         const int64_t first_month = first_month_at_or_after(window.start());
+         const int64_t end_month = month_index(end.date().year(), end.date().month());
+         int64_t total = 0;
+
+         // Months cut by the start or the end of the window.
+         auto month_start = [&](int64_t index) {
+             return Datetime(zone, Date(floor_div(index, 12), static_cast<Month>(floor_mod(index, 12))));
+         };
+         auto matches = [&](int64_t index) {
+             return _months.contains(static_cast<Month>(floor_mod(index, 12)));
+         };
+
+         if (matches(first_month - 1) && month_start(first_month) > window.start()) {
+             total += to_millis(std::min(month_start(first_month), end) - window.start());
+         }
+
+         if (end_month >= first_month && matches(end_month) && month_start(end_month) < end) {
+             total += to_millis(end - month_start(end_month));
+         }
+
+         // Whole months, measured between their zoned starts a run at
+         // a time, so that months the clocks change in aren't taken
+         // to be whole days long.
+         for (int64_t index = first_month; index < end_month;) {
+             if (! matches(index)) {
+                 index++;
+                 continue;
+             }
+
+             int64_t run_end = index + 1;
+             while (run_end < end_month && matches(run_end)) {
+                 run_end++;
+             }
+
+             total += to_millis(month_start(run_end) - month_start(index));
+             index = run_end;
+         }
+
+         return Duration::of_millis(total);
+     }
+
+     std::optional<Duration> min_spacing() const override {
+         int min_months = 12;
+
+         for (auto month : _months) {
+             for (auto other : _months) {
+                 const int months = floor_mod(static_cast<int>(other) - static_cast<int>(month), 12);
+                 if (months > 0) {
+                     min_months = std::min(min_months, months);
+                 }
+             }
+         }
+
+         return Duration::of_days(28 * min_months);
+     }
+
+     std::optional<Range> next_coalesced_range(const Datetime& dt) const override {
+         return month_run_range(dt.zone(), month_runs().next(first_month_at_or_after(dt + Duration::of_millis(1))));
+     }
+
+     std::optional<Range> prev_coalesced_range(const Datetime& dt) const override {
+         return month_run_range(dt.zone(), month_runs().prev(month_index(dt.date().year(), dt.date().month())));
+     }
+
      const std::set<Month>& months() const {
          return _months;
      }
@@ -65,29 +183,26 @@ class MonthFilter : public Filter {
          return moonlight::str::join(months, ",");
      }
 
+     size_t _hash() const override {
+         return hash_values(0, _months);
+     }
 
- private:
-     std::vector<Range> month_ranges(const Zone& zone, int year) const {
-         std::vector<Range> ranges;
-         std::vector<Month> months = sorted_months();
-
-         std::transform(months.begin(), months.end(),
-                        std::back_inserter(ranges),
-                        [=](Month month) {
-                            const Date date = Date(year, month);
-                            const Datetime start_dt = Datetime(zone, date);
-                            const Datetime end_dt = Datetime(zone, date.next_month());
-                            return Range(start_dt, end_dt);
-                        });
+     bool _equals(const Filter& other) const override {
+         const auto& filter = static_cast<const MonthFilter&>(other);
+         return _months == filter._months;
+     }
 
-         return ranges;
+ private:
+     // Runs of months.
+     SlotRuns month_runs() const {
+         return SlotRuns(
+             [this](int64_t index) { return _months.contains(static_cast<Month>(floor_mod(index, 12))); },
+             _months.size() == 12, 12);
      }
 
-     std::vector<Month> sorted_months() const {
-         std::vector<Month> months;
-         std::copy(_months.begin(), _months.end(), std::back_inserter(months));
-         std::sort(months.begin(), months.end());
-         return months;
+     static Range month_range(const Zone& zone, int year, Month month) {
+         const Date date = Date(year, month);
+         return Range(Datetime(zone, date), Datetime(zone, date.next_month()));
      }
 
      const std::set<Month> _months;
@@ -8,8 +8,12 @@
 #ifndef __TIMEFILTER_MONTHDAY_H
 #define __TIMEFILTER_MONTHDAY_H
 
+#include <array>
+#include "timefilter/calendar.h"
 #include "timefilter/constants.h"
 #include "timefilter/filter.h"
+#include "timefilter/intern.h"
+#include "timefilter/runs.h"
 
 namespace timefilter {
 
@@ -17,28 +21,38 @@ class MonthdayFilter : public Filter {
  public:
      MonthdayFilter(const int day) : Filter(FilterType::Monthday), _days({day}) {
          validate();
+         init_month_counts();
      }
 
      MonthdayFilter(const std::set<int>& days) : Filter(FilterType::Monthday), _days(days) {
          validate();
+         init_month_counts();
      }
 
      template<class V>
      static Pointer create(const V& param) {
-         return std::make_shared<MonthdayFilter>(param);
+         return interned<MonthdayFilter>(param);
      }
 
      std::optional<Range> next_range(const Datetime& dt) const override {
          Date range_month = dt.date().start_of_month();
 
          for (int x = 0; x < FRAME_SCAN_LIMIT; x++) {
-             auto ranges = monthday_ranges(dt.zone(), range_month.year(), range_month.month());
-             for (auto iter = ranges.begin(); iter != ranges.end(); iter++) {
-                 if (dt < iter->start()) {
-                     return *iter;
+             const int last_day = last_day_of_month(range_month.year(), range_month.month());
+             int first = 0;
+
+             for (auto day : _days) {
+                 const int month_day = resolve_day(day, last_day);
+                 if (month_day > 0 && (first == 0 || month_day < first) &&
+                     dt < Datetime(dt.zone(), Date(range_month.year(), range_month.month(), month_day))) {
+                     first = month_day;
                  }
              }
 
+             if (first > 0) {
+                 return day_range(dt.zone(), Date(range_month.year(), range_month.month(), first));
+             }
+
              range_month = range_month.next_month();
          }
 
@@ -49,23 +63,131 @@ class MonthdayFilter : public Filter {
          Date range_month = dt.date().start_of_month();
 
          for (int x = 0; x < FRAME_SCAN_LIMIT; x++) {
-             auto ranges = monthday_ranges(dt.zone(), range_month.year(), range_month.month());
-             for (auto iter = ranges.rbegin(); iter != ranges.rend(); iter++) {
-                 if (dt >= iter->start()) {
-                     return *iter;
+             const int last_day = last_day_of_month(range_month.year(), range_month.month());
+             int last = 0;
+
+             for (auto day : _days) {
+                 const int month_day = resolve_day(day, last_day);
+                 if (month_day > last &&
+                     dt >= Datetime(dt.zone(), Date(range_month.year(), range_month.month(), month_day))) {
+                     last = month_day;
                  }
              }
 
+             if (last > 0) {
+                 return day_range(dt.zone(), Date(range_month.year(), range_month.month(), last));
+             }
+
              range_month = range_month.prev_month();
          }
 
          THROW(Error, "Monthday filter could not find a prev range.");
      }
 
+     int64_t count(const Range& window) const override {
+         const auto [first_day, end_day] = day_span(window);
+
+         if (end_day <= first_day) {
+             return 0;
+         }
+
+         const Date first = date_from_epoch_days(first_day);
+         const Date last = date_from_epoch_days(end_day - 1);
+         const int64_t first_month = month_index(first.year(), first.month());
+         const int64_t last_month = month_index(last.year(), last.month());
+
+         if (first_month == last_month) {
+             return days_between(first.year(), first.month(), first.day(), last.day());
+         }
+
+         return days_between(first.year(), first.month(), first.day(), last_day_of_month(first.year(), first.month()))
+             + days_in_months(first_month + 1, last_month)
+             + days_between(last.year(), last.month(), 1, last.day());
+     }
+
+     Duration coverage(const Range& window) const override {
+         return _fixed_length_coverage(window, Duration::of_days(1));
+     }
+
+     Density density() const override {
+         double days = 0.0;
+
+         for (int month = 0; month < 12; month++) {
+             for_each_month_length(static_cast<Month>(month), [&](int last_day, double share) {
+                 days += _month_counts[last_day - 28] * share;
+             });
+         }
+
+         return {days, days / DAYS_PER_YEAR};
+     }
+
+     std::optional<Duration> min_spacing() const override {
+         std::array<std::vector<int>, 4> month_days;
+         int min_days = 31 * 2;
+
+         for (int last_day = 28; last_day <= 31; last_day++) {
+             auto& days = month_days[last_day - 28];
+             for (int day = 1; day <= last_day; day++) {
+                 if (matches(day, last_day)) {
+                     days.push_back(day);
+                 }
+             }
+             for (size_t x = 1; x < days.size(); x++) {
+                 min_days = std::min(min_days, days[x] - days[x - 1]);
+             }
+         }
+
+         // Across a month boundary, between months of any two lengths.
+         for (int last_day = 28; last_day <= 31; last_day++) {
+             for (const auto& next_days : month_days) {
+                 const auto& days = month_days[last_day - 28];
+                 if (! days.empty() && ! next_days.empty()) {
+                     min_days = std::min(min_days, next_days.front() + last_day - days.back());
+                 }
+             }
+         }
+
+         return Duration::of_days(min_days);
+     }
+
+     std::optional<Duration> cycle() const override {
+         return Duration::of_days(DAYS_PER_CYCLE);
+     }
+
+     bool follows_calendar() const override {
+         return true;
+     }
+
+     std::optional<Range> nth_next(const Datetime& dt, int64_t k) const override {
+         return _seek_nth_next(dt, k);
+     }
+
+     std::optional<Range> nth_prev(const Datetime& dt, int64_t k) const override {
+         return _seek_nth_prev(dt, k);
+     }
+
+     std::optional<Range> next_coalesced_range(const Datetime& dt) const override {
+         return day_run_range(dt.zone(), day_runs().next(first_day_at_or_after(dt + Duration::of_millis(1))));
+     }
+
+     std::optional<Range> prev_coalesced_range(const Datetime& dt) const override {
+         return day_run_range(dt.zone(), day_runs().prev(epoch_days(dt.date())));
+     }
+
+     std::optional<MonthDays> month_days(int year, Month month) const override {
+         return _month_spans[last_day_of_month(year, month) - 28];
+     }
+
      const std::set<int>& days() const {
          return _days;
      }
 
+     // Whether a day of a month `last_day` days long is one of the
+     // days, counting from either end of the month.
+     bool matches(int day, int last_day) const {
+         return _days.contains(day) || _days.contains(day - last_day - 1);
+     }
+
  protected:
      std::string _repr() const override {
          std::vector<int> monthdays;
@@ -74,6 +196,15 @@ class MonthdayFilter : public Filter {
          return moonlight::str::join(monthdays, ",");
      }
 
+     size_t _hash() const override {
+         return hash_values(0, _days);
+     }
+
+     bool _equals(const Filter& other) const override {
+         const auto& filter = static_cast<const MonthdayFilter&>(other);
+         return _days == filter._days;
+     }
+
  private:
      void validate() const {
          if (_days.size() == 0) {
@@ -88,28 +219,106 @@ class MonthdayFilter : public Filter {
          }
      }
 
-     std::vector<Range> monthday_ranges(const Zone& zone, int year, Month month) const {
-         std::vector<Range> ranges;
-         const int last_day = last_day_of_month(year, month);
+     // The number of distinct matching days in a month of each
+     // length from 28 to 31, and in a common year as a whole, along
+     // with the first and last of those days.
+     void init_month_counts() {
+         for (int last_day = 28; last_day <= 31; last_day++) {
+             int n = 0;
+             MonthDays span;
+             for (int day = 1; day <= last_day; day++) {
+                 if (matches(day, last_day)) {
+                     span.first = n == 0 ? day : span.first;
+                     span.last = day;
+                     n++;
+                 }
+             }
+             _month_counts[last_day - 28] = n;
+             _month_spans[last_day - 28] = span;
+         }
+
+         _common_year_count = 0;
+         for (int month = 0; month < 12; month++) {
+             _common_year_count += _month_counts[last_day_of_month(2001, static_cast<Month>(month)) - 28];
+         }
+     }
 
-         for (auto day : _days) {
-             if (std::abs(day) <= last_day) {
-                 auto date = Date(year, month, day > 0 ? day : last_day + day + 1);
+     int64_t days_between(int year, Month month, int first_day, int last_day) const {
+         const int month_length = last_day_of_month(year, month);
+         int64_t n = 0;
 
-                 ranges.push_back(Range(
-                         Datetime(zone, date),
-                         Datetime(zone, date.advance_days(1))));
-             }
+         for (int day = first_day; day <= last_day; day++) {
+             n += matches(day, month_length);
          }
 
-         std::sort(ranges.begin(), ranges.end(), [](const Range& rgA, const Range& rgB) {
-             return rgA.start() < rgB.start();
-         });
+         return n;
+     }
+
+     int64_t days_in_month(int64_t index) const {
+         return _month_counts[last_day_of_month(floor_div(index, 12), static_cast<Month>(floor_mod(index, 12))) - 28];
+     }
+
+     // Matching days in the months [a, b), counted by whole years
+     // where possible.
+     int64_t days_in_months(int64_t a, int64_t b) const {
+         int64_t n = 0;
+
+         for (; a < b && floor_mod(a, 12) != 0; a++) {
+             n += days_in_month(a);
+         }
+
+         if (b - a >= 12) {
+             const int64_t first_year = floor_div(a, 12);
+             const int64_t end_year = first_year + (b - a) / 12;
+             n += (end_year - first_year) * _common_year_count
+                 + count_leap_years(first_year, end_year) * (_month_counts[1] - _month_counts[0]);
+             a = end_year * 12;
+         }
+
+         for (; a < b; a++) {
+             n += days_in_month(a);
+         }
+
+         return n;
+     }
+
+     // Runs of days.  A run can only span the gap left by a missing
+     // leap day, so run starts are at most eight years apart.
+     SlotRuns day_runs() const {
+         bool full = true;
+         for (int last_day = 28; last_day <= 31; last_day++) {
+             full = full && _month_counts[last_day - 28] == last_day;
+         }
+
+         return SlotRuns(
+             [this](int64_t day) {
+                 const Date date = date_from_epoch_days(day);
+                 return matches(date.day(), last_day_of_month(date.year(), date.month()));
+             },
+             full, 8 * 366 + 31);
+     }
+
+     // The day of the month a monthday falls on, or 0 if the
+     // month is too short for it.
+     static int resolve_day(int day, int last_day) {
+         if (std::abs(day) > last_day) {
+             return 0;
+         }
+
+         return day > 0 ? day : last_day + day + 1;
+     }
 
-         return ranges;
+     static Range day_range(const Zone& zone, const Date& date) {
+         return Range(
+             Datetime(zone, date),
+             Datetime(zone, date.advance_days(1))
+         );
      }
 
      const std::set<int> _days;
+     std::array<int, 4> _month_counts;
+     std::array<MonthDays, 4> _month_spans;
+     int64_t _common_year_count;
 };
 
 }
@@ -18,7 +18,7 @@ class FilterOffset : public Filter {
      Filter(FilterType::FilterOffset), _filter(filter), _offset(offset) { }
 
      static Pointer create(Pointer filter, const Duration& offset) {
-         return std::make_shared<FilterOffset>(filter, offset);
+         return make_filter<FilterOffset>(filter, offset);
      }
 
      std::optional<Range> next_range(const Datetime& dt) const override {
@@ -49,6 +49,10 @@ class FilterOffset : public Filter {
          return {};
      }
 
+     std::optional<Duration> cycle() const override {
+         return _filter->cycle();
+     }
+
      Pointer filter() const {
          return _filter;
      }
@@ -64,6 +68,21 @@ class FilterOffset : public Filter {
          return sb.str();
      }
 
+     size_t _hash() const override {
+         return hash_combine(_filter->hash(), to_millis(_offset));
+     }
+
+     bool _equals(const Filter& other) const override {
+         const auto& filter = static_cast<const FilterOffset&>(other);
+         return _offset == filter._offset && _filter->equals(*filter._filter);
+     }
+
+     std::string _canonical() const override {
+         std::ostringstream sb;
+         sb << _filter->canonical() << " + " << _offset;
+         return sb.str();
+     }
+
  private:
      Pointer _filter;
      Duration _offset;
@@ -127,9 +127,12 @@ inline Grammar make_grammar(const I18nStrings& i18n) {
     const std::string term = "(?:[^\\w\\d]|$)";
     const std::string monthday_suffix = "(?:[a-z]+)";
     const std::string negation_slug = "([~])?";
+    const std::string cadence_unit = "(weeks?|w|days?|d|hours?|hrs?|h|minutes?|mins?|m)\\b";
+    const std::string cadence_anchor = "(?:\\s+from\\s+([0-9]{4,})-([0-9]{2})-([0-9]{2}))?";
 
     return Grammar()
     .def(lex::ignore("\\s+"))
+    .def(lex::match(tfm::format("every\\s+(other\\s+|[0-9]+\\s*)?%s%s", cadence_unit, cadence_anchor)).icase(), TokenType::CADENCE)
     .def(lex::match(tfm::format("([0-9]{1,2})%s %s ([0-9]{4,})", monthday_suffix, i18n.long_month_rx())).icase(), TokenType::DAY_MONTH_YEAR)
     .def(lex::match(tfm::format("([0-9]{1,2})%s %s ([0-9]{4,})", monthday_suffix, i18n.short_month_rx())).icase(), TokenType::DAY_MONTH_YEAR)
     .def(lex::match(tfm::format("%s ([0-9]{1,2})%s ([0-9]{4,})", i18n.long_month_rx(), monthday_suffix)).icase(), TokenType::MONTH_DAY_YEAR)
@@ -17,7 +17,7 @@ class RelativeRangeFilter : public Filter {
      RelativeRangeFilter(Pointer start_filter, Pointer end_filter) : Filter(FilterType::RelativeRange), _start_filter(start_filter), _end_filter(end_filter) { }
 
      static Pointer create(Pointer start_filter, Pointer end_filter) {
-         return std::make_shared<RelativeRangeFilter>(start_filter, end_filter);
+         return make_filter<RelativeRangeFilter>(start_filter, end_filter);
      }
 
      std::optional<Range> next_range(const Datetime& dt) const override {
@@ -65,6 +65,21 @@ class RelativeRangeFilter : public Filter {
          return sb.str();
      }
 
+     size_t _hash() const override {
+         return hash_combine(_start_filter->hash(), _end_filter->hash());
+     }
+
+     bool _equals(const Filter& other) const override {
+         const auto& filter = static_cast<const RelativeRangeFilter&>(other);
+         return _start_filter->equals(*filter._start_filter) && _end_filter->equals(*filter._end_filter);
+     }
+
+     std::string _canonical() const override {
+         std::ostringstream sb;
+         sb << _start_filter->canonical() << ", " << _end_filter->canonical();
+         return sb.str();
+     }
+
  private:
      Pointer _start_filter;
      Pointer _end_filter;
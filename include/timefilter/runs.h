@@ -0,0 +1,125 @@
+/*
+ * runs.h
+ *
+ * Author: Lain Musgrove (lain.proliant@gmail.com)
+ * Date: Sunday October 18, 2026
+ */
+
+#ifndef __TIMEFILTER_RUNS_H
+#define __TIMEFILTER_RUNS_H
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <utility>
+#include "timefilter/calendar.h"
+
+namespace timefilter {
+
+// --------------------------------------------------------
+// Maximal runs of consecutive slots matched by a filter,
+// where slots are consecutive integers such as epoch days,
+// month indexes or minutes of the local timeline.  Runs
+// are found from the filter's own slot membership test,
+// without building the ranges in between.
+//
+// A filter which matches every slot forms a single endless
+// run, which starts before any slot and so is never next.
+// --------------------------------------------------------
+typedef std::pair<int64_t, int64_t> SlotRun;
+
+const SlotRun ENDLESS_RUN = {std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max()};
+
+class SlotRuns {
+ public:
+     typedef std::function<bool(int64_t)> Predicate;
+
+     SlotRuns(Predicate matches, bool full, int64_t limit) :
+     _matches(matches), _full(full), _limit(limit) { }
+
+     // The first run starting at or after slot `n`.
+     std::optional<SlotRun> next(int64_t n) const {
+         if (_full) {
+             return {};
+         }
+
+         for (int64_t slot = n; slot < n + _limit; slot++) {
+             if (is_start(slot)) {
+                 return run_from(slot);
+             }
+         }
+
+         return {};
+     }
+
+     // The last run starting at or before slot `n`.
+     std::optional<SlotRun> prev(int64_t n) const {
+         if (_full) {
+             return ENDLESS_RUN;
+         }
+
+         for (int64_t slot = n; slot > n - _limit; slot--) {
+             if (is_start(slot)) {
+                 return run_from(slot);
+             }
+         }
+
+         return {};
+     }
+
+ private:
+     bool is_start(int64_t slot) const {
+         return _matches(slot) && ! _matches(slot - 1);
+     }
+
+     SlotRun run_from(int64_t slot) const {
+         int64_t end = slot + 1;
+
+         while (_matches(end)) {
+             end++;
+         }
+
+         return {slot, end};
+     }
+
+     Predicate _matches;
+     const bool _full;
+     const int64_t _limit;
+};
+
+inline Range endless_range() {
+    return Range(Datetime::min(), Datetime::max());
+}
+
+inline std::optional<Range> day_run_range(const Zone& zone, const std::optional<SlotRun>& run) {
+    if (! run.has_value()) {
+        return {};
+    }
+
+    if (*run == ENDLESS_RUN) {
+        return endless_range();
+    }
+
+    return Range(Datetime(zone, date_from_epoch_days(run->first)),
+                 Datetime(zone, date_from_epoch_days(run->second)));
+}
+
+inline std::optional<Range> month_run_range(const Zone& zone, const std::optional<SlotRun>& run) {
+    if (! run.has_value()) {
+        return {};
+    }
+
+    if (*run == ENDLESS_RUN) {
+        return endless_range();
+    }
+
+    auto month_start = [&](int64_t index) {
+        return Datetime(zone, Date(floor_div(index, 12), static_cast<Month>(floor_mod(index, 12))));
+    };
+    return Range(month_start(run->first), month_start(run->second));
+}
+
+}
+
+#endif /* !__TIMEFILTER_RUNS_H */
@@ -0,0 +1,200 @@
+/*
+ * search.h
+ *
+ * Author: Lain Musgrove (lain.proliant@gmail.com)
+ * Date: Sunday October 18, 2026
+ */
+
+#ifndef __TIMEFILTER_SEARCH_H
+#define __TIMEFILTER_SEARCH_H
+
+#include <queue>
+#include "timefilter/constants.h"
+#include "timefilter/stream.h"
+
+namespace timefilter {
+
+// --------------------------------------------------------
+// Lazily finds the gaps of at least `min_duration` within a
+// window that no filter's ranges cover, e.g. the free time
+// shared by everyone's recurring commitments.
+//
+// The coalesced range streams of all filters are merged by
+// start time in a single sweep.  Each stream is only
+// advanced once its current range has been consumed.
+// --------------------------------------------------------
+class GapStream {
+ public:
+     GapStream(const std::vector<Filter::Pointer>& filters, const Range& window, const Duration& min_duration) :
+     _window(window), _min_duration(min_duration), _busy_until(window.start()) {
+         for (const auto& filter : filters) {
+             // Ranges which started before the window may still cover it.
+             auto run = filter->prev_coalesced_range(window.start());
+             if (run.has_value() && run->end() > _busy_until) {
+                 _busy_until = run->end();
+             }
+
+             _streams.push_back(RangeStream(filter, window.start(), true));
+             advance(_streams.size() - 1);
+         }
+     }
+
+     std::optional<Range> next() {
+         while (! _done) {
+             if (_queue.empty() || _queue.top().range.start() >= _window.end()) {
+                 _done = true;
+                 return gap_until(_window.end());
+             }
+
+             const Entry entry = _queue.top();
+             _queue.pop();
+             advance(entry.stream);
+
+             auto gap = gap_until(entry.range.start());
+
+             if (entry.range.end() > _busy_until) {
+                 _busy_until = entry.range.end();
+             }
+
+             if (gap.has_value()) {
+                 return gap;
+             }
+         }
+
+         return {};
+     }
+
+     std::vector<Range> take(size_t n) {
+         std::vector<Range> gaps;
+
+         for (auto gap = next(); gap.has_value(); gap = next()) {
+             gaps.push_back(*gap);
+             if (gaps.size() == n) {
+                 break;
+             }
+         }
+
+         return gaps;
+     }
+
+ private:
+     struct Entry {
+         Range range;
+         size_t stream;
+
+         bool operator>(const Entry& other) const {
+             return range.start() > other.range.start();
+         }
+     };
+
+     void advance(size_t stream) {
+         auto range = _streams[stream].next();
+
+         if (range.has_value()) {
+             _queue.push({*range, stream});
+         }
+     }
+
+     std::optional<Range> gap_until(const Datetime& dt) const {
+         const Datetime end = std::min(dt, _window.end());
+
+         if (end > _busy_until && end - _busy_until >= _min_duration) {
+             return Range(_busy_until, end);
+         }
+
+         return {};
+     }
+
+     const Range _window;
+     const Duration _min_duration;
+     Datetime _busy_until;
+     std::vector<RangeStream> _streams;
+     std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> _queue;
+     bool _done = false;
+};
+
+// --------------------------------------------------------
+// The first range of at least `min_duration` at or after
+// `from` which is covered by every filter, found by a
+// leapfrog join over coalesced runs: each step moves the
+// pivot to the latest run start, or past the earliest run
+// end if the overlap is too short, and only the filters
+// whose runs end before the new pivot are queried again.
+// There's no such range once the pivot has passed two of
+// the filters' common periods without finding one.  Throws
+// Error if neither is settled within LEAPFROG_STEP_LIMIT
+// steps.
+// --------------------------------------------------------
+inline std::optional<Range> first_common(const std::vector<Filter::Pointer>& filters,
+                                         const Datetime& from,
+                                         const Duration& min_duration = Duration::zero()) {
+    if (filters.empty()) {
+        return {};
+    }
+
+    auto seek = [](const Filter::Pointer& filter, const Datetime& dt) {
+        auto run = filter->prev_coalesced_range(dt);
+        if (run.has_value() && run->end() > dt) {
+            return run;
+        }
+        return filter->next_coalesced_range(dt);
+    };
+
+    std::optional<int64_t> period = 1;
+    for (const auto& filter : filters) {
+        auto filter_period = filter->cycle();
+        period = period.has_value() && filter_period.has_value()
+            ? lcm_millis(*period, to_millis(*filter_period)) : std::nullopt;
+    }
+
+    std::vector<Range> runs;
+    Datetime pivot = from;
+
+    for (const auto& filter : filters) {
+        auto run = seek(filter, pivot);
+        if (! run.has_value()) {
+            return {};
+        }
+        runs.push_back(*run);
+    }
+
+    for (int x = 0; x < LEAPFROG_STEP_LIMIT; x++) {
+        Datetime start = pivot;
+        Datetime end = runs.front().end();
+
+        for (const auto& run : runs) {
+            start = std::max(start, run.start());
+            end = std::min(end, run.end());
+        }
+
+        if (end > start && end - start >= min_duration) {
+            return Range(start, end);
+        }
+
+        pivot = std::max(start, end);
+
+        if (period.has_value() && to_millis(pivot - from) >= 2 * *period) {
+            return {};
+        }
+
+        for (size_t n = 0; n < runs.size(); n++) {
+            if (runs[n].end() <= pivot) {
+                auto run = seek(filters[n], pivot);
+                if (! run.has_value()) {
+                    return {};
+                }
+                runs[n] = *run;
+            }
+        }
+    }
+
+    THROW(Error, "first_common() could not settle within " + std::to_string(LEAPFROG_STEP_LIMIT) + " steps.");
+}
+
+inline GapStream free_gaps(const std::vector<Filter::Pointer>& filters, const Range& window, const Duration& min_duration) {
+    return GapStream(filters, window, min_duration);
+}
+
+}
+
+#endif /* !__TIMEFILTER_SEARCH_H */
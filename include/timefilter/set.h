@@ -8,6 +8,10 @@
 #ifndef __TIMEFILTER_SET_H
 #define __TIMEFILTER_SET_H
 
+#include "timefilter/business_day.h"
+#include "timefilter/cadence.h"
+#include "timefilter/cron.h"
+#include "timefilter/date.h"
 #include "timefilter/filter.h"
 #include "timefilter/month.h"
 #include "timefilter/monthday.h"
@@ -16,10 +20,106 @@
 #include "timefilter/weekday_monthday.h"
 #include "timefilter/year.h"
 #include "timefilter/constants.h"
-#include <stack>
+#include <array>
+#include <atomic>
 
 namespace timefilter {
 
+// How a FilterSet intersects its filters.  Frames recurses from the
+// coarsest filter into each of its frames in turn.  Leapfrog moves
+// the finest filter forward and jumps it to the next frame of any
+// coarser filter it falls outside of, until they all agree, which
+// is much faster for sparse sets like "Feb 29 Mon 9:00".  Cron
+// finds the minute directly from bitsets of the set's months, days
+// and times, for sets of nothing else (see CronTable); others are
+// planned as if Auto.  Auto leaves the choice to the set's plan.
+enum class ScanStrategy {
+    Auto,
+    Frames,
+    Leapfrog,
+    Cron
+};
+
+// --------------------------------------------------------
+// The filters of a set from the finest at the bottom to the
+// coarsest at the top, borrowed from the set which owns
+// them.  Copying a stack copies a few raw pointers, so the
+// scans can pass it down by value without touching the
+// reference counts of shared filters.
+// --------------------------------------------------------
+class FilterStack {
+ public:
+     void push(const Filter* filter) {
+         _filters[_size++] = filter;
+     }
+
+     void pop() {
+         _size--;
+     }
+
+     const Filter* top() const {
+         return _filters[_size - 1];
+     }
+
+     const Filter* bottom() const {
+         return _filters[0];
+     }
+
+     // Indexed from the finest filter at the bottom.
+     const Filter* operator[](size_t n) const {
+         return _filters[n];
+     }
+
+     bool empty() const {
+         return _size == 0;
+     }
+
+     size_t size() const {
+         return _size;
+     }
+
+ private:
+     std::array<const Filter*, SET_STACK_DEPTH> _filters = {};
+     size_t _size = 0;
+};
+
+// --------------------------------------------------------
+// A value computed on first use and read without a lock.
+// Threads which find it missing each compute their own, and
+// the first to finish publishes it for every later reader.
+// --------------------------------------------------------
+template<class T>
+class LazyValue {
+ public:
+     template<class Make>
+     T get(Make make) const {
+         if (_state.load(std::memory_order_acquire) == READY) {
+             return _value;
+         }
+
+         T value = make();
+         int expected = EMPTY;
+
+         if (_state.compare_exchange_strong(expected, WRITING, std::memory_order_acquire)) {
+             _value = value;
+             _state.store(READY, std::memory_order_release);
+         }
+
+         return value;
+     }
+
+     // Like any other change to a filter, this mustn't race with
+     // readers.
+     void reset() {
+         _state.store(EMPTY, std::memory_order_relaxed);
+     }
+
+ private:
+     enum { EMPTY, WRITING, READY };
+     mutable std::atomic<int> _state = EMPTY;
+     mutable T _value = {};
+};
+
 class FilterSet : public Filter {
  public:
      typedef std::shared_ptr<FilterSet> Pointer;
@@ -29,7 +129,34 @@ class FilterSet : public Filter {
          bool dead = false;
      };
 
-     static std::string _dbg_print_stack(std::stack<Filter::Pointer> stack) {
+     // What a set's day filters prove about it, found by walking the
+     // months of one Gregorian cycle, or of its year if it has an
+     // absolute year or date.
+     // Sets with filters that aren't aligned to days aren't `known`.
+     struct Analysis {
+         bool known = false;
+         bool satisfiable = true;
+         bool bounded = false;
+         int64_t max_gap_days = 0;  // the longest run of days without a match
+     };
+
+     // How a set scans its filters.  Each frame around the finest
+     // filter is given the fraction of time it matches, and leapfrog
+     // checks them from the rarest up, so that the rarest frame drives
+     // the jumps.  Auto sets leapfrog when their frames are expected
+     // to rarely agree, and scan frames otherwise.  Sets which can be
+     // expressed as cron fields always use them.  Far pivots are
+     // moved by whole periods of the set before scanning.
+     struct Plan {
+         ScanStrategy strategy = ScanStrategy::Frames;
+         std::optional<CronTable> cron = {};
+         std::optional<Duration> period = {};
+         std::array<size_t, SET_STACK_DEPTH> order = {};  // stack indices, rarest first
+         std::array<double, SET_STACK_DEPTH> density = {};  // by stack index
+         size_t frames = 0;
+     };
+
+     static std::string _dbg_print_stack(FilterStack stack) {
          std::ostringstream sb;
          std::vector<std::string> elements;
          while (! stack.empty()) {
@@ -40,23 +167,211 @@ class FilterSet : public Filter {
          return sb.str();
      }
 
-     FilterSet() : Filter(FilterType::FilterSet) { }
-     FilterSet(Pointer set) : Filter(FilterType::FilterSet), _filters(set->_filters) { }
+     FilterSet() : Filter(FilterType::FilterSet), _filters(MemoryScope::resource()) { }
+
+     FilterSet(Pointer set) : Filter(FilterType::FilterSet), _filters(set->_filters, MemoryScope::resource()), _stack(set->_stack), _strategy(set->_strategy) { }
 
      static Pointer create() {
-         return std::make_shared<FilterSet>();
+         return make_filter<FilterSet>();
      }
 
      static Pointer create(Pointer set) {
-         return std::make_shared<FilterSet>(set);
+         return make_filter<FilterSet>(set);
      }
 
      std::optional<Range> next_range(const Datetime& dt) const override {
-         return _scan_next_range(Range::eternity(), dt, get_filter_stack()).range;
+         const Analysis set_analysis = analysis();
+         if (set_analysis.known && ! set_analysis.satisfiable) {
+             return {};
+         }
+
+         const Plan scan_plan = plan();
+         return _reduced_find(dt, scan_plan.period, [&](const Datetime& pivot) {
+             if (scan_plan.strategy == ScanStrategy::Cron) {
+                 return scan_plan.cron->next_range(pivot);
+             }
+
+             if (scan_plan.strategy == ScanStrategy::Leapfrog) {
+                 return _leapfrog_next_range(pivot, scan_plan);
+             }
+
+             return _scan_next_range(Range::eternity(), pivot, _stack, set_analysis).range;
+         });
      }
 
      std::optional<Range> prev_range(const Datetime& dt) const override {
-         return _scan_prev_range(Range::eternity(), dt, get_filter_stack()).range;
+         const Analysis set_analysis = analysis();
+         if (set_analysis.known && ! set_analysis.satisfiable) {
+             return {};
+         }
+
+         const Plan scan_plan = plan();
+         return _reduced_find(dt, scan_plan.period, [&](const Datetime& pivot) {
+             if (scan_plan.strategy == ScanStrategy::Cron) {
+                 return scan_plan.cron->prev_range(pivot);
+             }
+
+             if (scan_plan.strategy == ScanStrategy::Leapfrog) {
+                 return _leapfrog_prev_range(pivot, scan_plan);
+             }
+
+             return _scan_prev_range(Range::eternity(), pivot, _stack, set_analysis).range;
+         });
+     }
+
+     // Computed on first use and kept until the set changes.
+     Analysis analysis() const {
+         return _analysis.get([&]() { return _analyze(); });
+     }
+
+     // Also computed on first use, as filters without a closed form
+     // for their density are sampled over years, which adding filters
+     // one at a time mustn't pay for each time.
+     Plan plan() const {
+         return _plan.get([&]() { return _make_plan(); });
+     }
+
+     bool never_matches() const override {
+         const Analysis result = analysis();
+         return result.known && ! result.satisfiable;
+     }
+
+     // Matching days are never more than `max_gap_days` apart, and
+     // the last match is within a day of any instant on a matching day.
+     std::optional<Duration> max_wait() const override {
+         const Analysis result = analysis();
+
+         if (result.known && result.satisfiable && ! result.bounded) {
+             return Duration::of_days(result.max_gap_days + 2);
+         }
+
+         return Filter::max_wait();
+     }
+
+     ScanStrategy strategy() const {
+         return _strategy;
+     }
+
+     Pointer strategy(ScanStrategy strategy) {
+         _strategy = strategy;
+         _replan();
+         return std::static_pointer_cast<FilterSet>(shared_from_this());
+     }
+
+     int64_t count(const Range& window) const override {
+         return _count(window, _stack);
+     }
+
+     Duration coverage(const Range& window) const override {
+         // Times are never cut by the day or month frames around them.
+         if (_stack.size() > 1) {
+             auto innermost = _stack.bottom();
+             if (innermost->type() == FilterType::Time && *innermost->min_spacing() >= Duration::of_minutes(1)) {
+                 return _fixed_length_coverage(window, Duration::of_minutes(1));
+             }
+         }
+
+         return Duration::of_millis(_coverage(window, _stack));
+     }
+
+     std::optional<Duration> cycle() const override {
+         return _common_period(_filters);
+     }
+
+     bool follows_calendar() const override {
+         return ! _filters.empty() && std::all_of(_filters.begin(), _filters.end(), [](const auto& filter) {
+             return filter->follows_calendar();
+         });
+     }
+
+     // Sets of months, days of the month, weekdays and times have a
+     // closed form, taking weekdays as independent of the others.
+     // Other sets are sampled.
+     Density density() const override {
+         if (absolute_filter().has_value()) {
+             return {};
+         }
+
+         const MonthFilter* months = nullptr;
+         const MonthdayFilter* monthdays = nullptr;
+         const WeekdayMonthdayFilter* weekday_monthdays = nullptr;
+         const TimeFilter* times = nullptr;
+         double weekday_share = 1.0;
+         bool has_days = false;
+
+         for (const auto& filter : _filters) {
+             switch (filter->type()) {
+             case FilterType::Month:
+                 months = static_cast<const MonthFilter*>(filter.get());
+                 break;
+
+             case FilterType::Monthday:
+                 monthdays = static_cast<const MonthdayFilter*>(filter.get());
+                 has_days = true;
+                 break;
+
+             case FilterType::Time:
+                 times = static_cast<const TimeFilter*>(filter.get());
+                 break;
+
+             case FilterType::Weekday:
+                 weekday_share = static_cast<const WeekdayFilter&>(*filter).weekdays().size() / 7.0;
+                 has_days = true;
+                 break;
+
+             case FilterType::WeekdayMonthday:
+                 weekday_monthdays = static_cast<const WeekdayMonthdayFilter*>(filter.get());
+                 weekday_share = weekday_monthdays->weekdays().size() / 7.0;
+                 has_days = true;
+                 break;
+
+             default:
+                 return Filter::density();
+             }
+         }
+
+         double days = 0.0;
+
+         for (int x = 0; x < 12; x++) {
+             const Month month = static_cast<Month>(x);
+             if (months != nullptr && ! months->months().contains(month)) {
+                 continue;
+             }
+
+             for_each_month_length(month, [&](int last_day, double share) {
+                 for (int day = 1; day <= last_day; day++) {
+                     if ((monthdays == nullptr || monthdays->matches(day, last_day)) &&
+                         (weekday_monthdays == nullptr || weekday_monthdays->matches_monthday(day, last_day))) {
+                         days += share;
+                     }
+                 }
+             });
+         }
+
+         days *= weekday_share;
+
+         if (times != nullptr) {
+             const Density time_density = times->density();
+             return {days * time_density.per_year / DAYS_PER_YEAR, days / DAYS_PER_YEAR * time_density.fraction};
+         }
+
+         if (has_days) {
+             return {days, days / DAYS_PER_YEAR};
+         }
+
+         if (months != nullptr) {
+             return months->density();
+         }
+
+         return {};
+     }
+
+     std::optional<Range> nth_next(const Datetime& dt, int64_t k) const override {
+         return _seek_nth_next(dt, k);
+     }
+
+     std::optional<Range> nth_prev(const Datetime& dt, int64_t k) const override {
+         return _seek_nth_prev(dt, k);
      }
 
      bool empty() const {
@@ -67,66 +382,142 @@ class FilterSet : public Filter {
          return _filters.size();
      }
 
-     Pointer add(Filter::Pointer filter) {
-         if (filter->type() == FilterType::FilterSet) {
-             auto filter_set = std::static_pointer_cast<const FilterSet>(filter);
-             for (auto set_filter : filter_set->_filters) {
-                 add(set_filter);
+     const Filter::Vector& filters() const {
+         return _filters;
+     }
+
+     // A set of one filter is just that filter.  A year, a single month
+     // and a day filter matching only one day of it fold into a date.
+     Filter::Pointer simplify() const override {
+         auto date = determined_date();
+
+         if (date.has_value()) {
+             auto set = FilterSet::create();
+             set->add(DateFilter::create(*date));
+
+             for (const auto& filter : _filters) {
+                 if (filter->type() != FilterType::Year && filter->type() != FilterType::Month && ! is_day_filter(*filter)) {
+                     set->add(filter);
+                 }
              }
-             return std::static_pointer_cast<FilterSet>(shared_from_this());
-         }
 
-         if (filter->is_relative()) {
-             THROW(Error, "Sets cannot contain other relative filters: " + filter->type_name());;
+             return set->strategy(_strategy)->simplify();
          }
 
-         if (filter->is_absolute() && absolute_filter().has_value()) {
-             THROW(Error, "Sets cannot contain more than one absolute filter.  Set already contains "
-                   + (*absolute_filter())->type_name() + ", cannot add "
-                   + filter->type_name() + ".");
+         if (_filters.size() == 1) {
+             return _filters.front();
          }
 
-         switch(filter->type()) {
-         case FilterType::Datetime:
-             THROW(Error, "Datetime filter is absolute and atomic, thus cannot be part of a filter set.");
+         return shared_from_this();
+     }
 
-         case FilterType::Month:
-             ingest_month_filter(filter);
-             break;
+     Pointer add(Filter::Pointer filter) {
+         _ingest(filter);
+         _replan();
+         return std::static_pointer_cast<FilterSet>(shared_from_this());
+     }
 
-         case FilterType::Monthday:
-             ingest_monthday_filter(filter);
-             break;
+     // Adds many filters at once, with the same result as adding them
+     // in order.  Filters which would be merged one after another are
+     // combined up front, so each kind is ingested once rather than
+     // rebuilding a growing merged filter for every term.
+     Pointer add(const Filter::Vector& filters) {
+         Filter::Vector flat(MemoryScope::resource());
+         std::set<Month> months;
+         std::set<Time> times;
+         std::set<Weekday> weekdays, wm_weekdays;
+         std::set<int> monthdays, wm_monthdays;
+         std::optional<size_t> last_month, last_time, last_day;
+         bool has_weekdays = false, has_monthdays = false, has_wm = false;
+
+         for (const auto& filter : filters) {
+             if (filter->type() == FilterType::FilterSet) {
+                 const auto& set_filters = static_cast<const FilterSet&>(*filter)._filters;
+                 std::copy(set_filters.begin(), set_filters.end(), std::back_inserter(flat));
+             } else {
+                 flat.push_back(filter);
+             }
+         }
 
-         case FilterType::Time:
-             ingest_time_filter(filter);
-             break;
+         for (size_t x = 0; x < flat.size(); x++) {
+             const Filter& filter = *flat[x];
 
-         case FilterType::Weekday:
-             ingest_weekday_filter(filter);
-             break;
+             switch (filter.type()) {
+             case FilterType::Month: {
+                 const auto& filter_months = static_cast<const MonthFilter&>(filter).months();
+                 months.insert(filter_months.begin(), filter_months.end());
+                 last_month = x;
+                 break;
+             }
 
-         case FilterType::WeekdayMonthday:
-             ingest_weekday_monthday_filter(filter);
+             case FilterType::Time: {
+                 const auto& filter_times = static_cast<const TimeFilter&>(filter).times();
+                 times.insert(filter_times.begin(), filter_times.end());
+                 last_time = x;
+                 break;
+             }
 
-         case FilterType::WeekdayOfMonth:
-             ingest_weekday_of_month_filter(filter);
-             break;
+             case FilterType::Weekday: {
+                 const auto& filter_weekdays = static_cast<const WeekdayFilter&>(filter).weekdays();
+                 weekdays.insert(filter_weekdays.begin(), filter_weekdays.end());
+                 has_weekdays = true;
+                 last_day = x;
+                 break;
+             }
 
-         default:
-             if (filter->is_absolute()) {
-                 _filters.push_back(filter);
+             case FilterType::Monthday: {
+                 const auto& filter_days = static_cast<const MonthdayFilter&>(filter).days();
+                 monthdays.insert(filter_days.begin(), filter_days.end());
+                 has_monthdays = true;
+                 last_day = x;
+                 break;
+             }
+
+             case FilterType::WeekdayMonthday: {
+                 const auto& wm_filter = static_cast<const WeekdayMonthdayFilter&>(filter);
+                 wm_weekdays.insert(wm_filter.weekdays().begin(), wm_filter.weekdays().end());
+                 wm_monthdays.insert(wm_filter.monthdays().begin(), wm_filter.monthdays().end());
+                 has_wm = true;
+                 last_day = x;
+                 break;
+             }
+
+             default:
                  break;
              }
-             THROW(Error, "Filter set not prepared to handle filter: " + filter->type_name());
          }
-         validate();
 
+         // Each merged filter takes the place of the last of its kind,
+         // where adding them in order would have left it.
+         for (size_t x = 0; x < flat.size(); x++) {
+             if (x == last_month) {
+                 _ingest(MonthFilter::create(months));
+
+             } else if (x == last_time) {
+                 _ingest(TimeFilter::create(times));
+
+             } else if (x == last_day) {
+                 if (has_weekdays) {
+                     _ingest(WeekdayFilter::create(weekdays));
+                 }
+                 if (has_monthdays) {
+                     _ingest(MonthdayFilter::create(monthdays));
+                 }
+                 if (has_wm) {
+                     _ingest(WeekdayMonthdayFilter::create(wm_weekdays, wm_monthdays));
+                 }
+
+             } else if (! is_merged_type(flat[x]->type())) {
+                 _ingest(flat[x]);
+             }
+         }
+
+         _replan();
          return std::static_pointer_cast<FilterSet>(shared_from_this());
      }
 
      bool is_absolute() const override {
-         for (auto filter : _filters) {
+         for (const auto& filter : _filters) {
              if (! filter->is_absolute()) {
                  return false;
              }
@@ -138,12 +529,37 @@ class FilterSet : public Filter {
  protected:
      std::string _repr() const override {
          std::vector<std::string> reprs;
-         std::transform(_filters.begin(), _filters.end(), std::back_inserter(reprs), [](auto filter) {
+         std::transform(_filters.begin(), _filters.end(), std::back_inserter(reprs), [](const auto& filter) {
              return filter->repr();
          });
+
+         // Sets scanned frame by frame read as they always have,
+         // leapfrog sets show the order their frames are checked in.
+         const Plan scan_plan = plan();
+         if (scan_plan.strategy == ScanStrategy::Leapfrog) {
+             std::vector<std::string> order;
+             for (size_t n = 0; n < scan_plan.frames; n++) {
+                 order.push_back(_stack[scan_plan.order[n]]->type_name());
+             }
+             return moonlight::str::join(reprs, ",") + ";leapfrog:" + moonlight::str::join(order, ",");
+         }
+
          return moonlight::str::join(reprs, ",");
      }
 
+     size_t _hash() const override {
+         return _unordered_hash(_filters);
+     }
+
+     bool _equals(const Filter& other) const override {
+         const auto& filter = static_cast<const FilterSet&>(other);
+         return _unordered_equals(_filters, filter._filters);
+     }
+
+     std::string _canonical() const override {
+         return _unordered_canonical(_filters);
+     }
+
  private:
      void ingest_month_filter(Filter::Pointer filter) {
          std::shared_ptr<const MonthFilter> month_filter = static_pointer_cast<const MonthFilter>(filter);
@@ -164,6 +580,10 @@ class FilterSet : public Filter {
              THROW(Error, "Monthday is mutually exclusive with WeekdayOfMonth filters in sets.");
          }
 
+         if (get_filter(FilterType::BusinessDay)) {
+             THROW(Error, "Monthday and BusinessDay filters are mutually exclusive in sets.");
+         }
+
          auto prev_filter = get_filter({FilterType::Weekday, FilterType::Monthday, FilterType::WeekdayMonthday});
          Filter::Pointer new_filter = filter;
 
@@ -219,6 +639,10 @@ class FilterSet : public Filter {
              THROW(Error, "Weekday and WeekdayOfMonth filters are mutually exclusive in sets.");
          }
 
+         if (get_filter(FilterType::BusinessDay)) {
+             THROW(Error, "Weekday and BusinessDay filters are mutually exclusive in sets.");
+         }
+
          auto prev_filter = get_filter({FilterType::Weekday, FilterType::Monthday, FilterType::WeekdayMonthday});
          Filter::Pointer new_filter = filter;
 
@@ -260,6 +684,10 @@ class FilterSet : public Filter {
              THROW(Error, "WeekdayMonthday and WeekdayOfMonth filters are mutually exclusive in sets.");
          }
 
+         if (get_filter(FilterType::BusinessDay)) {
+             THROW(Error, "WeekdayMonthday and BusinessDay filters are mutually exclusive in sets.");
+         }
+
          auto prev_filter = get_filter({FilterType::Weekday, FilterType::Monthday, FilterType::WeekdayMonthday});
          Filter::Pointer new_filter = filter;
 
@@ -309,11 +737,35 @@ class FilterSet : public Filter {
              THROW(Error, "Multiple WeekdayOfMonth filters cannot be combined in sets.");
          }
 
+         if (get_filter(FilterType::BusinessDay)) {
+             THROW(Error, "WeekdayOfMonth and BusinessDay filters are mutually exclusive in sets.");
+         }
+
+         _filters.push_back(filter);
+     }
+
+     void ingest_business_day_filter(Filter::Pointer filter) {
+         if (get_filter({FilterType::Weekday, FilterType::Monthday, FilterType::WeekdayMonthday, FilterType::WeekdayOfMonth})) {
+             THROW(Error, "BusinessDay is mutually exclusive with other day filters in sets.");
+         }
+
+         if (get_filter(FilterType::BusinessDay)) {
+             THROW(Error, "Multiple BusinessDay filters cannot be combined in sets.");
+         }
+
+         _filters.push_back(filter);
+     }
+
+     void ingest_cadence_filter(Filter::Pointer filter) {
+         if (get_filter(FilterType::Cadence)) {
+             THROW(Error, "Multiple Cadence filters cannot be combined in sets.");
+         }
+
          _filters.push_back(filter);
      }
 
      std::optional<Filter::Pointer> absolute_filter() const {
-         for (auto filter : _filters) {
+         for (const auto& filter : _filters) {
              if (filter->is_absolute()) {
                  return filter;
              }
@@ -330,9 +782,8 @@ class FilterSet : public Filter {
          auto iter = _filters.begin();
 
          for (;iter != _filters.end(); iter++) {
-             auto filter = *iter;
-             if (types.contains(filter->type())) {
-                 return filter;
+             if (types.contains((*iter)->type())) {
+                 return *iter;
              }
          }
 
@@ -343,8 +794,7 @@ class FilterSet : public Filter {
          auto iter = _filters.begin();
 
          for (;iter != _filters.end(); iter++) {
-             auto filter = *iter;
-             if (filter->type() == type) {
+             if ((*iter)->type() == type) {
                  break;
              }
          }
@@ -358,33 +808,44 @@ class FilterSet : public Filter {
          return {};
      }
 
-     std::stack<Filter::Pointer> get_filter_stack() const {
-         std::stack<Filter::Pointer> stack;
-         std::vector<Filter::Pointer> filters;
+     // Built once as filters are added, the frames scanned by
+     // next_range() and prev_range() from the finest to the coarsest.
+     FilterStack get_filter_stack() const {
+         FilterStack stack;
+
+         // Cadences shorter than a day subdivide the time filter,
+         // longer cadences frame the day filter (e.g. alternate weeks).
+         auto cadence_filter_box = get_filter(FilterType::Cadence);
+         bool subday_cadence = cadence_filter_box.has_value() &&
+             std::static_pointer_cast<const CadenceFilter>(cadence_filter_box.value())->is_subday();
+
+         if (subday_cadence) {
+             stack.push(cadence_filter_box.value().get());
+         }
 
          auto time_filter_box = get_filter(FilterType::Time);
          if (time_filter_box.has_value()) {
-             stack.push(time_filter_box.value());
-             filters.push_back(time_filter_box.value());
+             stack.push(time_filter_box.value().get());
          }
 
-         auto day_filter_box = get_filter({FilterType::Monthday, FilterType::Weekday, FilterType::WeekdayMonthday, FilterType::WeekdayOfMonth});
+         auto day_filter_box = get_filter({FilterType::BusinessDay, FilterType::Monthday, FilterType::Weekday, FilterType::WeekdayMonthday, FilterType::WeekdayOfMonth});
 
          if (day_filter_box.has_value()) {
-             stack.push(day_filter_box.value());
-             filters.push_back(day_filter_box.value());
+             stack.push(day_filter_box.value().get());
+         }
+
+         if (cadence_filter_box.has_value() && ! subday_cadence) {
+             stack.push(cadence_filter_box.value().get());
          }
 
          auto month_filter_box = get_filter(FilterType::Month);
          if (month_filter_box.has_value()) {
-             stack.push(month_filter_box.value());
-             filters.push_back(month_filter_box.value());
+             stack.push(month_filter_box.value().get());
          }
 
          auto abs_filter_box = absolute_filter();
          if (abs_filter_box.has_value()) {
-             stack.push(abs_filter_box.value());
-             filters.push_back(abs_filter_box.value());
+             stack.push(abs_filter_box.value().get());
          }
 
          return stack;
@@ -445,13 +906,276 @@ class FilterSet : public Filter {
          }
      }
 
-     static ScanResult _scan_next_range(const Range& limit, const Datetime& dt, std::stack<Filter::Pointer> stack) {
+     std::optional<Date> determined_date() const {
+         auto year_filter_box = get_filter(FilterType::Year);
+         auto month_filter_box = get_filter(FilterType::Month);
+         auto day_filter_box = get_filter({FilterType::BusinessDay, FilterType::Monthday, FilterType::Weekday, FilterType::WeekdayMonthday, FilterType::WeekdayOfMonth});
+
+         if (! year_filter_box.has_value() || ! month_filter_box.has_value() || ! day_filter_box.has_value()) {
+             return {};
+         }
+
+         const auto& months = std::static_pointer_cast<const MonthFilter>(month_filter_box.value())->months();
+
+         if (months.size() != 1) {
+             return {};
+         }
+
+         const int year = std::static_pointer_cast<const YearFilter>(year_filter_box.value())->year();
+         const Month month = *months.begin();
+         auto days = day_filter_box.value()->month_days(year, month);
+
+         if (! days.has_value() || days->empty() || days->first != days->last) {
+             return {};
+         }
+
+         return Date(year, month, days->first);
+     }
+
+     void _ingest(Filter::Pointer filter) {
+         if (filter->type() == FilterType::FilterSet) {
+             for (const auto& set_filter : static_cast<const FilterSet&>(*filter)._filters) {
+                 _ingest(set_filter);
+             }
+             return;
+         }
+
+         if (filter->is_relative()) {
+             THROW(Error, "Sets cannot contain other relative filters: " + filter->type_name());;
+         }
+
+         if (filter->is_absolute() && absolute_filter().has_value()) {
+             THROW(Error, "Sets cannot contain more than one absolute filter.  Set already contains "
+                   + (*absolute_filter())->type_name() + ", cannot add "
+                   + filter->type_name() + ".");
+         }
+
+         switch(filter->type()) {
+         case FilterType::BusinessDay:
+             ingest_business_day_filter(filter);
+             break;
+
+         case FilterType::Cadence:
+             ingest_cadence_filter(filter);
+             break;
+
+         case FilterType::Datetime:
+             THROW(Error, "Datetime filter is absolute and atomic, thus cannot be part of a filter set.");
+
+         case FilterType::Month:
+             ingest_month_filter(filter);
+             break;
+
+         case FilterType::Monthday:
+             ingest_monthday_filter(filter);
+             break;
+
+         case FilterType::Time:
+             ingest_time_filter(filter);
+             break;
+
+         case FilterType::Weekday:
+             ingest_weekday_filter(filter);
+             break;
+
+         case FilterType::WeekdayMonthday:
+             ingest_weekday_monthday_filter(filter);
+             break;
+
+         case FilterType::WeekdayOfMonth:
+             ingest_weekday_of_month_filter(filter);
+             break;
+
+         default:
+             if (filter->is_absolute()) {
+                 _filters.push_back(filter);
+                 break;
+             }
+             THROW(Error, "Filter set not prepared to handle filter: " + filter->type_name());
+         }
+         validate();
+     }
+
+     // The stack is remade as soon as the set changes, the analysis
+     // and the plan on their next use.
+     void _replan() {
+         _stack = get_filter_stack();
+         _analysis.reset();
+         _plan.reset();
+     }
+
+     Plan _make_plan() const {
+         Plan plan;
+         plan.period = cycle();
+         plan.frames = _stack.empty() ? 0 : _stack.size() - 1;
+
+         for (size_t n = 0; n < plan.frames; n++) {
+             plan.order[n] = _stack.size() - 1 - n;
+         }
+
+         if ((_strategy == ScanStrategy::Auto || _strategy == ScanStrategy::Cron) && CronTable::eligible(_filters)) {
+             plan.strategy = ScanStrategy::Cron;
+             plan.cron.emplace(_filters);
+             return plan;
+         }
+
+         if (_strategy == ScanStrategy::Frames || plan.frames == 0) {
+             plan.strategy = _strategy == ScanStrategy::Leapfrog ? ScanStrategy::Leapfrog : ScanStrategy::Frames;
+             return plan;
+         }
+
+         // Ties keep the coarser frame first, as frames are scanned.
+         for (size_t n = 0; n < plan.frames; n++) {
+             plan.density[plan.order[n]] = _stack[plan.order[n]]->density().fraction;
+         }
+
+         std::stable_sort(plan.order.begin(), plan.order.begin() + plan.frames, [&](size_t a, size_t b) {
+             return plan.density[a] < plan.density[b];
+         });
+
+         if (_strategy == ScanStrategy::Leapfrog) {
+             plan.strategy = ScanStrategy::Leapfrog;
+             return plan;
+         }
+
+         // If the frames were independent, they would all agree this
+         // often.  Much less often than the rarest of them matches
+         // means most of its frames would be scanned for nothing.
+         double agreement = 1.0;
+         for (size_t n = 0; n < plan.frames; n++) {
+             agreement *= plan.density[plan.order[n]];
+         }
+
+         const double rarest = plan.density[plan.order[0]];
+         plan.strategy = agreement < rarest * PLAN_LEAPFROG_AGREEMENT ? ScanStrategy::Leapfrog : ScanStrategy::Frames;
+         return plan;
+     }
+
+     // Intersects the matching days of each filter month by month.
+     // At most one filter in a set matches only part of a month, the
+     // others match whole months, so the span of days left in each
+     // month is exact.  Times match on every day.
+     Analysis _analyze() const {
+         std::vector<Filter::Pointer> day_filters;
+         std::optional<int> year;
+
+         for (const auto& filter : _filters) {
+             if (filter->type() == FilterType::Time) {
+                 continue;
+             }
+
+             if (! filter->month_days(2000, Month::January).has_value()) {
+                 return {};
+             }
+
+             if (filter->type() == FilterType::Year) {
+                 year = std::static_pointer_cast<const YearFilter>(filter)->year();
+             } else if (filter->type() == FilterType::Date) {
+                 year = std::static_pointer_cast<const DateFilter>(filter)->date().year();
+             }
+
+             day_filters.push_back(filter);
+         }
+
+         const int64_t first_month = month_index(year.value_or(2000), Month::January);
+         const int64_t end_month = first_month + (year.has_value() ? 12 : 12 * 400);
+         std::optional<int64_t> first_day;
+         std::optional<int64_t> last_day;
+         int64_t max_gap = 0;
+
+         for (int64_t index = first_month; index < end_month; index++) {
+             const int month_year = floor_div(index, 12);
+             const Month month = static_cast<Month>(floor_mod(index, 12));
+             MonthDays days = {1, last_day_of_month(month_year, month)};
+
+             for (const auto& filter : day_filters) {
+                 const MonthDays filter_days = *filter->month_days(month_year, month);
+                 days.first = std::max(days.first, filter_days.first);
+                 days.last = std::min(days.last, filter_days.last);
+
+                 if (filter_days.empty() || days.first > days.last) {
+                     days = {};
+                     break;
+                 }
+             }
+
+             if (days.empty()) {
+                 continue;
+             }
+
+             const int64_t month_start = epoch_days(month_year, month, 1) - 1;
+
+             if (last_day.has_value()) {
+                 max_gap = std::max(max_gap, month_start + days.first - *last_day - 1);
+             } else {
+                 first_day = month_start + days.first;
+             }
+
+             max_gap = std::max(max_gap, int64_t(days.last - days.first - 1));
+             last_day = month_start + days.last;
+         }
+
+         if (! first_day.has_value()) {
+             return {.known=true, .satisfiable=false};
+         }
+
+         if (year.has_value()) {
+             return {.known=true, .satisfiable=true, .bounded=true,
+                     .max_gap_days=epoch_days(*year + 1, Month::January, 1) - epoch_days(*year, Month::January, 1)};
+         }
+
+         // The cycle repeats, so the gap around its ends counts too.
+         max_gap = std::max(max_gap, *first_day + DAYS_PER_CYCLE - *last_day - 1);
+         return {.known=true, .satisfiable=true, .max_gap_days=max_gap};
+     }
+
+     // A proven gap between matching days bounds the frames to scan
+     // at each level by the shortest frame there can be: a day for
+     // days and dates, 28 days for months and 365 for years.  Other
+     // levels aren't covered by the analysis, so they keep the
+     // constant limit.
+     static int _frame_limit(const Filter& filter, const Analysis& result) {
+         int64_t min_days = 0;
+
+         switch (filter.type()) {
+         case FilterType::BusinessDay:
+         case FilterType::Date:
+         case FilterType::Monthday:
+         case FilterType::Weekday:
+         case FilterType::WeekdayMonthday:
+         case FilterType::WeekdayOfMonth:
+             min_days = 1;
+             break;
+
+         case FilterType::Month:
+             min_days = 28;
+             break;
+
+         case FilterType::Year:
+             min_days = 365;
+             break;
+
+         default:
+             return FRAME_SCAN_LIMIT;
+         }
+
+         if (! result.known) {
+             return FRAME_SCAN_LIMIT;
+         }
+
+         // The gap and the days either side of it, which may start
+         // and end partway through a frame.
+         return static_cast<int>((result.max_gap_days + 2 + min_days - 1) / min_days + 1);
+     }
+
+     static ScanResult _scan_next_range(const Range& limit, const Datetime& dt, FilterStack stack, const Analysis& analysis) {
          if (stack.empty()) {
              return {};
          }
 
          auto filter = stack.top();
          stack.pop();
+         const int frames = _frame_limit(*filter, analysis);
          auto next_rg = filter->next_range(dt);
 
          if (stack.empty()) {
@@ -466,7 +1190,7 @@ class FilterSet : public Filter {
          auto current_rg = filter->current_range(dt);
 
          if (current_rg.has_value()) {
-             auto result = _scan_next_range(*current_rg, dt, stack);
+             auto result = _scan_next_range(*current_rg, dt, stack, analysis);
 
              if (result.dead) {
                  return {.range={}, .dead=true};
@@ -483,8 +1207,8 @@ class FilterSet : public Filter {
 
          auto frame_rg = next_rg;
 
-         for (int x = 0; x < FRAME_SCAN_LIMIT && frame_rg.has_value() && limit.intersects(*frame_rg); x++) {
-             auto result = _scan_next_range(*frame_rg, frame_rg->start() - Duration::of_millis(1), stack);
+         for (int x = 0; x < frames && frame_rg.has_value() && limit.intersects(*frame_rg); x++) {
+             auto result = _scan_next_range(*frame_rg, frame_rg->start() - Duration::of_millis(1), stack, analysis);
              if (result.dead || result.range.has_value()) {
                  return result;
              }
@@ -495,7 +1219,7 @@ class FilterSet : public Filter {
          return {.range={}, .dead=false};
      }
 
-     static ScanResult _scan_prev_range(const Range& limit, const Datetime& dt, std::stack<Filter::Pointer> stack) {
+     static ScanResult _scan_prev_range(const Range& limit, const Datetime& dt, FilterStack stack, const Analysis& analysis) {
          if (stack.empty()) {
              return {};
          }
@@ -503,6 +1227,7 @@ class FilterSet : public Filter {
 
          auto filter = stack.top();
          stack.pop();
+         const int frames = _frame_limit(*filter, analysis);
          auto prev_rg = filter->prev_range(dt);
 
          if (stack.empty()) {
@@ -520,8 +1245,8 @@ class FilterSet : public Filter {
 
          auto frame_rg = prev_rg;
 
-         for (int x = 0; x < FRAME_SCAN_LIMIT && frame_rg.has_value() && limit.intersects(*frame_rg); x++) {
-             auto result = _scan_prev_range(*frame_rg, frame_rg->end() - Duration::of_millis(1), stack);
+         for (int x = 0; x < frames && frame_rg.has_value() && limit.intersects(*frame_rg); x++) {
+             auto result = _scan_prev_range(*frame_rg, std::min(dt, frame_rg->end() - Duration::of_millis(1)), stack, analysis);
              if (result.dead || result.range.has_value()) {
                  return result;
              }
@@ -529,10 +1254,218 @@ class FilterSet : public Filter {
              frame_rg = filter->prev_range(frame_rg->start() - Duration::of_millis(1));
          }
 
-         return {.range={}, .dead=true};
+         return {.range={}, .dead=false};
+     }
+
+     // Sums the coverage of the innermost filter within each of the
+     // frames around it, as in _count().
+     static int64_t _coverage(const Range& limit, FilterStack stack) {
+         if (stack.empty()) {
+             return 0;
+         }
+
+         auto filter = stack.top();
+         stack.pop();
+
+         if (stack.empty()) {
+             return to_millis(filter->coverage(limit));
+         }
+
+         int64_t total = 0;
+         auto frame_rg = filter->current_range(limit.start());
+
+         if (! frame_rg.has_value()) {
+             frame_rg = filter->next_range(limit.start());
+         }
+
+         for (; frame_rg.has_value() && frame_rg->start() < limit.end();
+              frame_rg = filter->next_range(frame_rg->start())) {
+             total += _coverage(Range(std::max(frame_rg->start(), limit.start()),
+                                      std::min(frame_rg->end(), limit.end())), stack);
+         }
+
+         return total;
+     }
+
+     std::optional<Range> _leapfrog_next_range(const Datetime& dt, const Plan& plan) const {
+         const auto& filters = _stack;
+
+         if (filters.empty()) {
+             return {};
+         }
+
+         Datetime pivot = dt;
+
+         for (int x = 0; x < LEAPFROG_STEP_LIMIT; x++) {
+             auto range = filters.bottom()->next_range(pivot);
+
+             if (! range.has_value()) {
+                 return {};
+             }
+
+             bool agreed = true;
+
+             for (size_t n = 0; n < plan.frames; n++) {
+                 const Filter* filter = filters[plan.order[n]];
+                 auto frame = filter->current_range(range->start());
+
+                 if (frame.has_value()) {
+                     range = range->clip_to(*frame);
+                     continue;
+                 }
+
+                 auto next_frame = filter->next_range(range->start());
+
+                 if (! next_frame.has_value()) {
+                     return {};
+                 }
+
+                 pivot = next_frame->start() - Duration::of_millis(1);
+                 agreed = false;
+                 break;
+             }
+
+             if (agreed) {
+                 return range;
+             }
+         }
+
+         THROW(Error, "FilterSet could not find a next range within " + std::to_string(LEAPFROG_STEP_LIMIT) + " leapfrog steps.");
+     }
+
+     std::optional<Range> _leapfrog_prev_range(const Datetime& dt, const Plan& plan) const {
+         const auto& filters = _stack;
+
+         if (filters.empty()) {
+             return {};
+         }
+
+         Datetime pivot = dt;
+
+         for (int x = 0; x < LEAPFROG_STEP_LIMIT; x++) {
+             auto range = filters.bottom()->prev_range(pivot);
+
+             if (! range.has_value()) {
+                 return {};
+             }
+
+             bool agreed = true;
+
+             for (size_t n = 0; n < plan.frames; n++) {
+                 const Filter* filter = filters[plan.order[n]];
+                 auto frame = filter->current_range(range->start());
+
+                 if (frame.has_value()) {
+                     range = range->clip_to(*frame);
+                     continue;
+                 }
+
+                 auto prev_frame = filter->prev_range(range->start());
+
+                 if (! prev_frame.has_value()) {
+                     return {};
+                 }
+
+                 pivot = prev_frame->end() - Duration::of_millis(1);
+                 agreed = false;
+                 break;
+             }
+
+             if (agreed) {
+                 return range;
+             }
+         }
+
+         THROW(Error, "FilterSet could not find a prev range within " + std::to_string(LEAPFROG_STEP_LIMIT) + " leapfrog steps.");
+     }
+
+     // Filters which are merged with others of their kind when added.
+     static bool is_merged_type(FilterType type) {
+         switch (type) {
+         case FilterType::Month:
+         case FilterType::Monthday:
+         case FilterType::Time:
+         case FilterType::Weekday:
+         case FilterType::WeekdayMonthday:
+             return true;
+         default:
+             return false;
+         }
+     }
+
+     static bool is_day_filter(const Filter& filter) {
+         static const std::set<FilterType> day_filter_types = {
+             FilterType::BusinessDay, FilterType::Monthday, FilterType::Weekday,
+             FilterType::WeekdayMonthday, FilterType::WeekdayOfMonth
+         };
+         return day_filter_types.contains(filter.type());
+     }
+
+     // Counts by walking the frames of each filter in the stack, handing
+     // the innermost filter a window clipped to its frame.  Times within
+     // day filters are counted as whole days times the number of times,
+     // so only the partial days at either end of the window are walked.
+     static int64_t _count(const Range& limit, FilterStack stack) {
+         if (stack.empty()) {
+             return 0;
+         }
+
+         auto filter = stack.top();
+         stack.pop();
+
+         if (stack.empty()) {
+             return filter->count(limit);
+         }
+
+         if (stack.size() == 1 && stack.top()->type() == FilterType::Time && is_day_filter(*filter)) {
+             return _count_day_times(limit, *filter, static_cast<const TimeFilter&>(*stack.top()));
+         }
+
+         int64_t n = 0;
+         auto frame_rg = filter->current_range(limit.start());
+
+         if (! frame_rg.has_value()) {
+             frame_rg = filter->next_range(limit.start());
+         }
+
+         for (; frame_rg.has_value() && frame_rg->start() < limit.end();
+              frame_rg = filter->next_range(frame_rg->start())) {
+             n += _count(Range(std::max(frame_rg->start(), limit.start()),
+                               std::min(frame_rg->end(), limit.end())), stack);
+         }
+
+         return n;
+     }
+
+     static int64_t _count_day_times(const Range& limit, const Filter& days, const TimeFilter& times) {
+         const Duration one_day = Duration::of_days(1);
+         const Duration one_ms = Duration::of_millis(1);
+         int64_t n = 0;
+
+         auto front_rg = days.current_range(limit.start());
+         if (front_rg.has_value() && front_rg->start() < limit.start()) {
+             n += times.count(Range(limit.start(), std::min(front_rg->end(), limit.end())));
+         }
+
+         if (limit.end() - limit.start() >= one_day) {
+             n += days.count(Range(limit.start(), limit.end() - one_day + one_ms))
+                 * static_cast<int64_t>(times.times().size());
+         }
+
+         const Datetime back_start = std::max(limit.start(), limit.end() - one_day + one_ms);
+         auto back_rg = days.next_range(back_start - one_ms);
+         if (back_rg.has_value() && back_rg->start() < limit.end()) {
+             n += times.count(Range(back_rg->start(), std::min(back_rg->end(), limit.end())));
+         }
+
+         return n;
      }
 
-     std::vector<Filter::Pointer> _filters;
+     Filter::Vector _filters;
+     FilterStack _stack;
+     ScanStrategy _strategy = ScanStrategy::Auto;
+     LazyValue<Analysis> _analysis;
+     LazyValue<Plan> _plan;
 };
 
 }
@@ -9,6 +9,7 @@
 #define __TIMEFILTER_STATIC_RANGE_H
 
 #include "timefilter/filter.h"
+#include "timefilter/intern.h"
 
 namespace timefilter {
 
@@ -17,7 +18,7 @@ class StaticRangeFilter : public Filter {
      StaticRangeFilter(const Range& range) : Filter(FilterType::StaticRange), _range(range) { }
 
      static Pointer create(const Range& range) {
-         return std::make_shared<StaticRangeFilter>(range);
+         return interned<StaticRangeFilter>(range);
      }
 
      static Pointer create(const Datetime& dt, const Duration& duration) {
@@ -49,6 +50,20 @@ class StaticRangeFilter : public Filter {
          return sb.str();
      }
 
+     // As for DatetimeFilter, zones are part of the filter.
+     size_t _hash() const override {
+         const size_t zones = hash_combine(std::hash<std::string>()(_range.start().zone().name()),
+                                           std::hash<std::string>()(_range.end().zone().name()));
+         return hash_combine(hash_combine(zones, instant_millis(_range.start())), instant_millis(_range.end()));
+     }
+
+     bool _equals(const Filter& other) const override {
+         const auto& filter = static_cast<const StaticRangeFilter&>(other);
+         return _range == filter._range
+             && _range.start().zone().name() == filter._range.start().zone().name()
+             && _range.end().zone().name() == filter._range.end().zone().name();
+     }
+
  private:
      const Range _range;
 };
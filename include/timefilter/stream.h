@@ -0,0 +1,63 @@
+/*
+ * stream.h
+ *
+ * Author: Lain Musgrove (lain.proliant@gmail.com)
+ * Date: Sunday October 18, 2026
+ */
+
+#ifndef __TIMEFILTER_STREAM_H
+#define __TIMEFILTER_STREAM_H
+
+#include "timefilter/filter.h"
+
+namespace timefilter {
+
+// --------------------------------------------------------
+// Lazily enumerates the ranges of a filter which start at
+// or after a pivot.  With `coalesce`, each range is a
+// maximal run of contiguous ranges instead.
+// --------------------------------------------------------
+class RangeStream {
+ public:
+     RangeStream(Filter::Pointer filter, const Datetime& pivot, bool coalesce = false) :
+     _filter(filter), _dt(pivot - Duration::of_millis(1)), _coalesce(coalesce) { }
+
+     std::optional<Range> next() {
+         if (_done) {
+             return {};
+         }
+
+         auto range = _coalesce ? _filter->next_coalesced_range(_dt) : _filter->next_range(_dt);
+
+         if (range.has_value()) {
+             _dt = range->start();
+         } else {
+             _done = true;
+         }
+
+         return range;
+     }
+
+     std::vector<Range> take(size_t n) {
+         std::vector<Range> ranges;
+
+         for (auto range = next(); range.has_value(); range = next()) {
+             ranges.push_back(*range);
+             if (ranges.size() == n) {
+                 break;
+             }
+         }
+
+         return ranges;
+     }
+
+ private:
+     Filter::Pointer _filter;
+     Datetime _dt;
+     bool _coalesce;
+     bool _done = false;
+};
+
+}
+
+#endif /* !__TIMEFILTER_STREAM_H */
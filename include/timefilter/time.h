@@ -8,7 +8,11 @@
 #ifndef __TIMEFILTER_TIME_H
 #define __TIMEFILTER_TIME_H
 
+#include <bitset>
+#include "timefilter/calendar.h"
 #include "timefilter/filter.h"
+#include "timefilter/intern.h"
+#include "timefilter/runs.h"
 
 namespace timefilter {
 
@@ -21,17 +25,17 @@ class TimeFilter : public Filter {
 
      template<class V>
      static Pointer create(const V& param) {
-         return std::make_shared<TimeFilter>(param);
+         return interned<TimeFilter>(param);
      }
 
      std::optional<Range> next_range(const Datetime& dt) const override {
          for (Date date = dt.date();
               Datetime(dt.zone(), date) - dt <= Duration::of_days(2);
               date = date.advance_days(1)) {
-             auto ranges = time_ranges(dt.zone(), date);
-             for (auto iter = ranges.begin(); iter != ranges.end(); iter++) {
-                 if (dt < iter->start()) {
-                     return *iter;
+             for (auto iter = _times.begin(); iter != _times.end(); iter++) {
+                 auto range = time_range(dt.zone(), date, *iter);
+                 if (dt < range.start()) {
+                     return range;
                  }
              }
          }
@@ -43,10 +47,10 @@ class TimeFilter : public Filter {
          for (Date date = dt.date();
               dt - Datetime(dt.zone(), date) <= Duration::of_days(2);
               date = date.recede_days(1)) {
-             auto ranges = time_ranges(dt.zone(), date);
-             for (auto iter = ranges.rbegin(); iter != ranges.rend(); iter++) {
-                 if (dt >= iter->start()) {
-                     return *iter;
+             for (auto iter = _times.rbegin(); iter != _times.rend(); iter++) {
+                 auto range = time_range(dt.zone(), date, *iter);
+                 if (dt >= range.start()) {
+                     return range;
                  }
              }
          }
@@ -54,10 +58,114 @@ class TimeFilter : public Filter {
          THROW(Error, "Time filter could not find a prev range.");
      }
 
+     int64_t count(const Range& window) const override {
+         const Zone& zone = window.start().zone();
+         const int64_t start = local_millis(window.start());
+         const int64_t end = local_millis(window.end().zone(zone));
+         const Date epoch = Date(1970, Month::January, 1);
+         int64_t n = 0;
+
+         for (const auto& time : _times) {
+             n += count_congruent(start, end, local_millis(Datetime(zone, epoch, time)), MILLIS_PER_DAY);
+         }
+
+         return n;
+     }
+
+     Duration coverage(const Range& window) const override {
+         if (*min_spacing() < Duration::of_minutes(1)) {
+             return Filter::coverage(window);
+         }
+
+         return _fixed_length_coverage(window, Duration::of_minutes(1));
+     }
+
+     // Each time matches for a minute a day, unless they overlap.
+     Density density() const override {
+         if (*min_spacing() < Duration::of_minutes(1)) {
+             return Filter::density();
+         }
+
+         return {_times.size() * DAYS_PER_YEAR, _times.size() / 1440.0};
+     }
+
+     std::optional<Duration> min_spacing() const override {
+         std::vector<int64_t> millis;
+         const Date epoch = Date(1970, Month::January, 1);
+
+         for (const auto& time : _times) {
+             millis.push_back(local_millis(Datetime(epoch, time)));
+         }
+
+         std::sort(millis.begin(), millis.end());
+         int64_t min_millis = millis.front() + MILLIS_PER_DAY - millis.back();
+
+         for (size_t x = 1; x < millis.size(); x++) {
+             min_millis = std::min(min_millis, millis[x] - millis[x - 1]);
+         }
+
+         return Duration::of_millis(min_millis == 0 ? MILLIS_PER_DAY : min_millis);
+     }
+
+     std::optional<Duration> cycle() const override {
+         return Duration::of_days(1);
+     }
+
+     bool follows_calendar() const override {
+         return true;
+     }
+
+     std::optional<Range> nth_next(const Datetime& dt, int64_t k) const override {
+         return _seek_nth_next(dt, k);
+     }
+
+     std::optional<Range> nth_prev(const Datetime& dt, int64_t k) const override {
+         return _seek_nth_prev(dt, k);
+     }
+
+     std::optional<Range> next_coalesced_range(const Datetime& dt) const override {
+         auto minutes = minutes_of_day();
+
+         if (! minutes.has_value()) {
+             return Filter::next_coalesced_range(dt);
+         }
+
+         return minute_run_range(dt.zone(), minute_runs(*minutes).next(floor_div(local_millis(dt), MILLIS_PER_MINUTE) + 1));
+     }
+
+     std::optional<Range> prev_coalesced_range(const Datetime& dt) const override {
+         auto minutes = minutes_of_day();
+
+         if (! minutes.has_value()) {
+             return Filter::prev_coalesced_range(dt);
+         }
+
+         return minute_run_range(dt.zone(), minute_runs(*minutes).prev(floor_div(local_millis(dt), MILLIS_PER_MINUTE)));
+     }
+
      const std::set<Time>& times() const {
          return _times;
      }
 
+     static const int64_t MILLIS_PER_MINUTE = 60000;
+     static const int MINUTES_PER_DAY = 1440;
+
+     // The minutes of the day matched, if every time is on the minute.
+     std::optional<std::bitset<MINUTES_PER_DAY>> minutes_of_day() const {
+         std::bitset<MINUTES_PER_DAY> minutes;
+         const Date epoch = Date(1970, Month::January, 1);
+
+         for (const auto& time : _times) {
+             const int64_t millis = local_millis(Datetime(epoch, time));
+             if (millis % MILLIS_PER_MINUTE != 0) {
+                 return {};
+             }
+             minutes.set(millis / MILLIS_PER_MINUTE);
+         }
+
+         return minutes;
+     }
+
  protected:
      std::string _repr() const override {
          std::vector<Time> times;
@@ -70,6 +178,19 @@ class TimeFilter : public Filter {
          return moonlight::str::join(iso_times, ",");
      }
 
+     size_t _hash() const override {
+         size_t hash = 0;
+         for (const auto& time : _times) {
+             hash = hash_combine(hash, local_millis(Datetime(Date(1970, Month::January, 1), time)));
+         }
+         return hash_combine(hash, _times.size());
+     }
+
+     bool _equals(const Filter& other) const override {
+         const auto& filter = static_cast<const TimeFilter&>(other);
+         return _times == filter._times;
+     }
+
  private:
      void validate() const {
          if (_times.size() == 0) {
@@ -77,22 +198,29 @@ class TimeFilter : public Filter {
          }
      }
 
-     std::vector<Range> time_ranges(const Zone& zone, const Date& date) const {
-         std::vector<Range> ranges;
+     // Runs of minutes on the local timeline.
+     static SlotRuns minute_runs(const std::bitset<MINUTES_PER_DAY>& minutes) {
+         return SlotRuns(
+             [minutes](int64_t minute) { return minutes.test(floor_mod(minute, MINUTES_PER_DAY)); },
+             minutes.all(), MINUTES_PER_DAY + 1);
+     }
 
-         for (auto time : sorted_times()) {
-             auto dt = Datetime(zone, date, time);
-             ranges.push_back(Range(dt, dt + Duration::of_minutes(1)));
+     static std::optional<Range> minute_run_range(const Zone& zone, const std::optional<SlotRun>& run) {
+         if (! run.has_value()) {
+             return {};
          }
 
-         return ranges;
+         if (*run == ENDLESS_RUN) {
+             return endless_range();
+         }
+
+         return Range(from_local_millis(zone, run->first * MILLIS_PER_MINUTE),
+                      from_local_millis(zone, run->second * MILLIS_PER_MINUTE));
      }
 
-     std::vector<Time> sorted_times() const {
-         std::vector<Time> times;
-         std::copy(_times.begin(), _times.end(), std::back_inserter(times));
-         std::sort(times.begin(), times.end());
-         return times;
+     static Range time_range(const Zone& zone, const Date& date, const Time& time) {
+         auto dt = Datetime(zone, date, time);
+         return Range(dt, dt + Duration::of_minutes(1));
      }
 
      const std::set<Time> _times;
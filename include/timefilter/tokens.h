@@ -18,6 +18,7 @@ namespace lex = moonlight::lex;
 
 // ------------------------------------------------------------------
 enum class TokenType {
+    CADENCE,
     COMMENT,
     DAY_MONTH,
     DAY_MONTH_YEAR,
@@ -47,6 +48,7 @@ enum class TokenType {
 inline const std::string& token_type_name(TokenType type) {
     static const std::string _unknown = "UNKNOWN";
     static const std::map<TokenType, std::string> _names = {
+        {TokenType::CADENCE, "CADENCE"},
         {TokenType::COMMENT, "COMMENT"},
         {TokenType::DAY_MONTH, "DAY_MONTH"},
         {TokenType::DAY_OF_MONTH, "DAY_OF_MONTH"},
@@ -8,7 +8,10 @@
 #ifndef __TIMEFILTER_WEEKDAY_H
 #define __TIMEFILTER_WEEKDAY_H
 
+#include "timefilter/calendar.h"
 #include "timefilter/filter.h"
+#include "timefilter/intern.h"
+#include "timefilter/runs.h"
 
 namespace timefilter {
 
@@ -22,15 +25,16 @@ class WeekdayFilter : public Filter {
 
      template<class V>
      static Pointer create(const V& value) {
-         return std::make_shared<WeekdayFilter>(value);
+         return interned<WeekdayFilter>(value);
      }
 
      std::optional<Range> next_range(const Datetime& dt) const override {
-         auto ranges = weekday_ranges(dt.zone(), dt.date());
+         const Date date = dt.date();
 
-         for (auto iter = ranges.begin(); iter != ranges.end(); iter++) {
-             if (dt < iter->start()) {
-                 return *iter;
+         for (int x = 0; x <= 7; x++) {
+             auto new_date = date.advance_days(x);
+             if (_weekdays.contains(new_date.weekday()) && dt < Datetime(dt.zone(), new_date)) {
+                 return day_range(dt.zone(), new_date);
              }
          }
 
@@ -38,17 +42,93 @@ class WeekdayFilter : public Filter {
      }
 
      std::optional<Range> prev_range(const Datetime& dt) const override {
-         auto ranges = weekday_ranges(dt.zone(), dt.date().recede_days(6));
+         const Date date = dt.date().advance_days(1);
 
-         for (auto iter = ranges.rbegin(); iter != ranges.rend(); iter++) {
-             if (dt >= iter->start()) {
-                 return *iter;
+         for (int x = 0; x <= 7; x++) {
+             auto new_date = date.recede_days(x);
+             if (_weekdays.contains(new_date.weekday()) && dt >= Datetime(dt.zone(), new_date)) {
+                 return day_range(dt.zone(), new_date);
              }
          }
 
         THROW(Error, "Weekday filter could not find a prev range.");
      }
 
+     int64_t count(const Range& window) const override {
+         const auto [first_day, end_day] = day_span(window);
+         int64_t n = 0;
+
+         for (auto weekday : _weekdays) {
+             n += count_congruent(first_day, end_day, floor_mod(static_cast<int>(weekday) - 4, 7), 7);
+         }
+
+         return n;
+     }
+
+     Duration coverage(const Range& window) const override {
+         return _fixed_length_coverage(window, Duration::of_days(1));
+     }
+
+     Density density() const override {
+         const double share = _weekdays.size() / 7.0;
+         return {share * DAYS_PER_YEAR, share};
+     }
+
+     std::optional<Duration> min_spacing() const override {
+         int min_days = 7;
+
+         for (auto weekday : _weekdays) {
+             for (auto other : _weekdays) {
+                 const int days = floor_mod(static_cast<int>(other) - static_cast<int>(weekday), 7);
+                 if (days > 0) {
+                     min_days = std::min(min_days, days);
+                 }
+             }
+         }
+
+         return Duration::of_days(min_days);
+     }
+
+     std::optional<MonthDays> month_days(int year, Month month) const override {
+         const int last_day = last_day_of_month(year, month);
+         const int first_weekday = epoch_weekday(epoch_days(year, month, 1));
+         const int last_weekday = (first_weekday + last_day - 1) % 7;
+         int first_offset = 6;
+         int last_offset = 6;
+
+         for (auto weekday : _weekdays) {
+             const int weekday_id = static_cast<int>(weekday);
+             first_offset = std::min(first_offset, static_cast<int>(floor_mod(weekday_id - first_weekday, 7)));
+             last_offset = std::min(last_offset, static_cast<int>(floor_mod(last_weekday - weekday_id, 7)));
+         }
+
+         return MonthDays{1 + first_offset, last_day - last_offset};
+     }
+
+     std::optional<Duration> cycle() const override {
+         return Duration::of_days(7);
+     }
+
+     bool follows_calendar() const override {
+         return true;
+     }
+
+     std::optional<Range> nth_next(const Datetime& dt, int64_t k) const override {
+         return _seek_nth_next(dt, k);
+     }
+
+     std::optional<Range> nth_prev(const Datetime& dt, int64_t k) const override {
+         return _seek_nth_prev(dt, k);
+     }
+
+     std::optional<Range> next_coalesced_range(const Datetime& dt) const override {
+         return day_run_range(dt.zone(), day_runs().next(first_day_at_or_after(dt + Duration::of_millis(1))));
+     }
+
+     std::optional<Range> prev_coalesced_range(const Datetime& dt) const override {
+         return day_run_range(dt.zone(), day_runs().prev(epoch_days(dt.date())));
+     }
+
      const std::set<Weekday>& weekdays() const {
          return _weekdays;
      }
@@ -70,6 +150,14 @@ class WeekdayFilter : public Filter {
          return moonlight::str::join(weekday_strs);
      }
 
+     size_t _hash() const override {
+         return hash_values(0, _weekdays);
+     }
+
+     bool _equals(const Filter& other) const override {
+         const auto& filter = static_cast<const WeekdayFilter&>(other);
+         return _weekdays == filter._weekdays;
+     }
 
  private:
      void validate() const {
@@ -78,20 +166,18 @@ class WeekdayFilter : public Filter {
          }
      }
 
-     std::vector<Range> weekday_ranges(const Zone& zone, const Date& date) const {
-         std::vector<Range> ranges;
-
-         for (int x = 0; x <= 7; x++) {
-             auto new_date = date.advance_days(x);
-             if (_weekdays.contains(new_date.weekday())) {
-                 ranges.push_back(Range(
-                         Datetime(zone, new_date),
-                         Datetime(zone, new_date.advance_days(1))
-                 ));
-             }
-         }
+     // Runs of days.
+     SlotRuns day_runs() const {
+         return SlotRuns(
+             [this](int64_t day) { return _weekdays.contains(static_cast<Weekday>(epoch_weekday(day))); },
+             _weekdays.size() == 7, 7);
+     }
 
-         return ranges;
+     static Range day_range(const Zone& zone, const Date& date) {
+         return Range(
+             Datetime(zone, date),
+             Datetime(zone, date.advance_days(1))
+         );
      }
 
      const std::set<Weekday> _weekdays;
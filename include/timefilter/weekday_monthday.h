@@ -9,6 +9,7 @@
 #define __TIMEFILTER_WEEKDAY_MONTHDAY_H
 
 #include "timefilter/filter.h"
+#include "timefilter/intern.h"
 
 namespace timefilter {
 
@@ -44,22 +45,22 @@ class WeekdayMonthdayFilter : public Filter {
 
      template<class V>
      static Pointer create(const V& value) {
-         return std::make_shared<WeekdayMonthdayFilter>(value);
+         return interned<WeekdayMonthdayFilter>(value);
      }
 
      template<class V1, class V2>
      static Pointer create(const V1& value1, const V2& value2) {
-         return std::make_shared<WeekdayMonthdayFilter>(value1, value2);
+         return interned<WeekdayMonthdayFilter>(value1, value2);
      }
 
      std::optional<Range> next_range(const Datetime& dt) const override {
          auto date = dt.date().advance_days(1);
          int year = date.year();
          Month month = date.month();
-         auto monthdays = monthdays_for_month(date.year(), date.month());
+         int last_day = last_day_of_month(year, month);
 
          for (;;) {
-             if (monthdays.contains(date.day()) &&
+             if (matches_monthday(date.day(), last_day) &&
                  _weekdays.contains(date.weekday())) {
                  return Range(
                      Datetime(dt.zone(), date),
@@ -69,9 +70,9 @@ class WeekdayMonthdayFilter : public Filter {
 
              date = date.advance_days(1);
              if (year != date.year() || month != date.month()) {
-                 monthdays = monthdays_for_month(date.year(), date.month());
                  year = date.year();
                  month = date.month();
+                 last_day = last_day_of_month(year, month);
              }
          }
      }
@@ -80,10 +81,10 @@ class WeekdayMonthdayFilter : public Filter {
          auto date = dt.date();
          int year = date.year();
          Month month = date.month();
-         auto monthdays = monthdays_for_month(date.year(), date.month());
+         int last_day = last_day_of_month(year, month);
 
          for (;;) {
-             if (monthdays.contains(date.day()) &&
+             if (matches_monthday(date.day(), last_day) &&
                  _weekdays.contains(date.weekday())) {
                  return Range(
                      Datetime(dt.zone(), date),
@@ -93,13 +94,68 @@ class WeekdayMonthdayFilter : public Filter {
 
              date = date.recede_days(1);
              if (year != date.year() || month != date.month()) {
-                 monthdays = monthdays_for_month(date.year(), date.month());
                  year = date.year();
                  month = date.month();
+                 last_day = last_day_of_month(year, month);
              }
          }
      }
 
+     std::optional<MonthDays> month_days(int year, Month month) const override {
+         const int last_day = last_day_of_month(year, month);
+         const int first_weekday = epoch_weekday(epoch_days(year, month, 1));
+         MonthDays days;
+
+         for (int day : _monthdays) {
+             if (day < 0) {
+                 day = last_day + day + 1;
+             }
+
+             if (day < 1 || day > last_day ||
+                 ! _weekdays.contains(static_cast<Weekday>((first_weekday + day - 1) % 7))) {
+                 continue;
+             }
+
+             if (days.empty() || day < days.first) {
+                 days.first = day;
+             }
+             days.last = std::max(days.last, day);
+         }
+
+         return days;
+     }
+
+     std::optional<Duration> cycle() const override {
+         return Duration::of_days(DAYS_PER_CYCLE);
+     }
+
+     bool follows_calendar() const override {
+         return true;
+     }
+
+     // Weekdays are spread evenly enough over the cycle to be taken
+     // as independent of the days of the month.
+     Density density() const override {
+         double days = 0.0;
+
+         for (int month = 0; month < 12; month++) {
+             for_each_month_length(static_cast<Month>(month), [&](int last_day, double share) {
+                 for (int day = 1; day <= last_day; day++) {
+                     days += matches_monthday(day, last_day) * share;
+                 }
+             });
+         }
+
+         days *= _weekdays.size() / 7.0;
+         return {days, days / DAYS_PER_YEAR};
+     }
+
+     // Whether a day of a month `last_day` days long is one of the
+     // monthdays, counting from either end of the month.
+     bool matches_monthday(int day, int last_day) const {
+         return _monthdays.contains(day) || _monthdays.contains(day - last_day - 1);
+     }
+
      const std::set<Weekday>& weekdays() const {
          return _weekdays;
      }
@@ -135,27 +191,16 @@ class WeekdayMonthdayFilter : public Filter {
          return moonlight::str::join(reprs, ",");
      }
 
- private:
-     std::set<int> monthdays_for_month(int year, Month month) const {
-         std::set<int> monthdays;
-         const int last_day = last_day_of_month(year, month);
-
-         for (int day : _monthdays) {
-             if (day < 0) {
-                 day = last_day - (day - 1);
-
-                 if (day > 0) {
-                     monthdays.insert(day);
-                 }
-
-             } else if (day <= last_day) {
-                 monthdays.insert(day);
-             }
-         }
+     size_t _hash() const override {
+         return hash_values(hash_values(0, _weekdays), _monthdays);
+     }
 
-         return monthdays;
+     bool _equals(const Filter& other) const override {
+         const auto& filter = static_cast<const WeekdayMonthdayFilter&>(other);
+         return _weekdays == filter._weekdays && _monthdays == filter._monthdays;
      }
 
+ private:
      void validate() {
          if (_weekdays.size() == 0) {
              THROW(Error, "At least one weekday must be provided for WeekdayMonthdayFilter.");
@@ -8,7 +8,9 @@
 #ifndef __TIMEFILTER_WEEKDAY_OF_MONTH_H
 #define __TIMEFILTER_WEEKDAY_OF_MONTH_H
 
+#include "timefilter/calendar.h"
 #include "timefilter/filter.h"
+#include "timefilter/intern.h"
 
 namespace timefilter {
 
@@ -19,7 +21,7 @@ class WeekdayOfMonthFilter : public Filter {
      }
 
      static Pointer create(Weekday weekday, int offset) {
-         return std::make_shared<WeekdayOfMonthFilter>(weekday, offset);
+         return interned<WeekdayOfMonthFilter>(weekday, offset);
      }
 
      std::optional<Range> next_range(const Datetime& dt) const override {
@@ -48,6 +50,79 @@ class WeekdayOfMonthFilter : public Filter {
         THROW(Error, "WeekdayOfMonth filter could not find a prev range.");
      }
 
+     int64_t count(const Range& window) const override {
+         const auto [first_day, end_day] = day_span(window);
+
+         if (end_day <= first_day) {
+             return 0;
+         }
+
+         const Date first = date_from_epoch_days(first_day);
+         const Date last = date_from_epoch_days(end_day - 1);
+         const int64_t first_month = month_index(first.year(), first.month());
+         const int64_t last_month = month_index(last.year(), last.month());
+
+         auto in_window = [&](int64_t index) -> int64_t {
+             auto date = date_in_month(index);
+             if (! date.has_value()) {
+                 return 0;
+             }
+             const int64_t day = epoch_days(*date);
+             return day >= first_day && day < end_day;
+         };
+
+         if (first_month == last_month) {
+             return in_window(first_month);
+         }
+
+         int64_t n = in_window(first_month) + in_window(last_month);
+
+         // Every month has at least four of each weekday.
+         if (std::abs(_offset) <= 4) {
+             return n + last_month - first_month - 1;
+         }
+
+         for (int64_t index = first_month + 1; index < last_month; index++) {
+             n += date_in_month(index).has_value();
+         }
+
+         return n;
+     }
+
+     std::optional<Range> nth_next(const Datetime& dt, int64_t k) const override {
+         return _seek_nth_next(dt, k);
+     }
+
+     std::optional<Range> nth_prev(const Datetime& dt, int64_t k) const override {
+         return _seek_nth_prev(dt, k);
+     }
+
+     Duration coverage(const Range& window) const override {
+         return _fixed_length_coverage(window, Duration::of_days(1));
+     }
+
+     std::optional<Duration> min_spacing() const override {
+         return Duration::of_days(28);
+     }
+
+     std::optional<Duration> cycle() const override {
+         return Duration::of_days(DAYS_PER_CYCLE);
+     }
+
+     bool follows_calendar() const override {
+         return true;
+     }
+
+     std::optional<MonthDays> month_days(int year, Month month) const override {
+         auto date = date_in_month(year, month);
+
+         if (date.has_value()) {
+             return MonthDays{date->day(), date->day()};
+         }
+
+         return MonthDays{};
+     }
+
      Weekday weekday() const {
          return _weekday;
      }
@@ -67,6 +142,15 @@ class WeekdayOfMonthFilter : public Filter {
          return sb.str();
      }
 
+     size_t _hash() const override {
+         return hash_combine(hash_mix(static_cast<uint64_t>(_weekday)), _offset);
+     }
+
+     bool _equals(const Filter& other) const override {
+         const auto& filter = static_cast<const WeekdayOfMonthFilter&>(other);
+         return _weekday == filter._weekday && _offset == filter._offset;
+     }
+
  private:
      void validate() const {
          if (_offset < -5 || _offset > 5 || _offset == 0) {
@@ -74,42 +158,38 @@ class WeekdayOfMonthFilter : public Filter {
          }
      }
 
-     std::optional<Range> monthday_range(const Zone& zone, int year, Month month) const {
-         const Date month_start = Date(year, month);
-         const Date month_end = month_start.end_of_month();
-         Date date;
+     std::optional<Date> date_in_month(int year, Month month) const {
+         const int last_day = last_day_of_month(year, month);
+         const int weekday = static_cast<int>(_weekday);
+         int day;
 
          if (_offset > 0) {
-             date = month_start;
-
-             for (int x = 0; x < _offset; date = date.advance_days(1)) {
-                 if (date.weekday() == _weekday) {
-                     x++;
-
-                     if (x == _offset) {
-                         break;
-                     }
-                 }
-             }
+             const int first_weekday = epoch_weekday(epoch_days(year, month, 1));
+             day = 1 + floor_mod(weekday - first_weekday, 7) + 7 * (_offset - 1);
 
          } else {
-             date = month_end;
-             for (int x = 0; x > _offset; date = date.recede_days(1)) {
-                 if (date.weekday() == _weekday) {
-                     x--;
-
-                     if (x == _offset) {
-                         break;
-                     }
-                 }
-             }
+             const int last_weekday = epoch_weekday(epoch_days(year, month, last_day));
+             day = last_day - floor_mod(last_weekday - weekday, 7) + 7 * (_offset + 1);
+         }
+
+         if (day < 1 || day > last_day) {
+             return {};
          }
 
-         if (date.year() == month_start.year() &&
-             date.month() == month_start.month()) {
+         return Date(year, month, day);
+     }
+
+     std::optional<Date> date_in_month(int64_t index) const {
+         return date_in_month(floor_div(index, 12), static_cast<Month>(floor_mod(index, 12)));
+     }
+
+     std::optional<Range> monthday_range(const Zone& zone, int year, Month month) const {
+         auto date = date_in_month(year, month);
+
+         if (date.has_value()) {
              return Range(
-                 Datetime(zone, date),
-                 Datetime(zone, date.advance_days(1))
+                 Datetime(zone, *date),
+                 Datetime(zone, date->advance_days(1))
              );
          }
 
@@ -9,6 +9,7 @@
 #define __TIMEFILTER_YEAR_H
 
 #include "timefilter/filter.h"
+#include "timefilter/intern.h"
 
 namespace timefilter {
 
@@ -17,7 +18,7 @@ class YearFilter : public Filter {
      YearFilter(int year) : Filter(FilterType::Year), _year(year) { }
 
      static Pointer create(int year) {
-         return std::make_shared<YearFilter>(year);
+         return interned<YearFilter>(year);
      }
 
      std::optional<Range> next_range(const Datetime& dt) const override {
@@ -40,6 +41,14 @@ class YearFilter : public Filter {
          return {};
      }
 
+     std::optional<MonthDays> month_days(int year, Month month) const override {
+         if (year == _year) {
+             return MonthDays{1, last_day_of_month(year, month)};
+         }
+
+         return MonthDays{};
+     }
+
      int year() const {
          return _year;
      }
@@ -51,6 +60,15 @@ class YearFilter : public Filter {
          return sb.str();
      }
 
+     size_t _hash() const override {
+         return hash_mix(_year);
+     }
+
+     bool _equals(const Filter& other) const override {
+         const auto& filter = static_cast<const YearFilter&>(other);
+         return _year == filter._year;
+     }
+
  private:
      Range year_range(const Zone& zone) const {
          const Date this_year = Date(_year, Month::January);
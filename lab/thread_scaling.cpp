@@ -0,0 +1,82 @@
+/*
+ * thread_scaling.cpp
+ *
+ * Author: Lain Musgrove (lain.proliant@gmail.com)
+ * Date: Sunday October 18, 2026
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include "timefilter/compiler.h"
+#include "timefilter/parser.h"
+
+using namespace timefilter;
+
+// Evaluates one shared schedule from 1, 2, 4... threads and
+// reports the throughput of each, to show how evaluation of
+// a popular filter scales across cores.  Threads only
+// contend when they run at once, so on a single core the
+// numbers show the cost of switching threads and say
+// nothing about contention.
+//
+// Usage: thread_scaling [expr] [evaluations-per-thread]
+int main(int argc, char** argv) {
+    const std::string expr = argc > 1 ? argv[1] : "Mon, Wed, Fri 9:00 - 17:00 @ Jan Mar May Jul Sep Nov";
+    const int evaluations = argc > 2 ? std::stoi(argv[2]) : 20000;
+    const int max_threads = std::max(1u, std::thread::hardware_concurrency());
+
+    Parser parser;
+    Compiler compiler;
+    const auto filter = compiler.compile_filter(parser.parse(expr));
+    const Datetime pivot = Datetime(2025, Month::January, 1);
+
+    std::cout << "filter = " << *filter << std::endl;
+
+    if (max_threads == 1) {
+        std::cout << "Only one core is available, so scaling can't be measured." << std::endl;
+    }
+
+    for (int thread_count = 1; thread_count <= max_threads; thread_count *= 2) {
+        std::vector<std::thread> threads;
+        std::vector<int64_t> found(thread_count, 0);
+        auto start = std::chrono::steady_clock::now();
+
+        for (int n = 0; n < thread_count; n++) {
+            threads.emplace_back([&, n]() {
+                Datetime dt = pivot + Duration::of_days(n);
+                int64_t count = 0;
+
+                for (int x = 0; x < evaluations; x++) {
+                    auto range = filter->next_range(dt);
+                    if (! range.has_value()) {
+                        break;
+                    }
+                    dt = range->end();
+                    count++;
+                }
+
+                // Counted locally, as neighbouring slots of `found`
+                // share a cache line.
+                found[n] = count;
+            });
+        }
+
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        int64_t total = 0;
+        for (auto n : found) {
+            total += n;
+        }
+
+        std::cout << thread_count << " threads: " << total << " ranges in " << elapsed << "s, "
+            << static_cast<int64_t>(total / elapsed) << " ranges/s" << std::endl;
+    }
+
+    return 0;
+}
@@ -6,6 +6,8 @@
  */
 
 #include "moonlight/date.h"
+#include "timefilter/gap_stats.h"
+#include "timefilter/weekday_of_month.h"
 
 using namespace moonlight::date;
 
@@ -27,41 +29,20 @@ int main() {
 
     const Weekday weekday = static_cast<Weekday>(std::distance(weekday_names.begin(), iter));
     const int offset = std::stoi(syntax_vec[1]);
-    Date month_start = Date::today().start_of_month();
-    const Date last_day = Date(month_start.year() + count_years, month_start.month());
-    std::vector<Datetime> dts;
+    const Date first_day = Date::today().start_of_month();
+    const Date last_day = Date(first_day.year() + count_years, first_day.month());
+    const Range window = Range(Datetime(first_day), Datetime(last_day));
+    const auto filter = timefilter::WeekdayOfMonthFilter::create(weekday, offset);
 
-    for (; month_start < last_day; month_start = month_start.next_month()) {
-        Date d = month_start;
+    std::cout << "Number of " << syntax_vec[0] << "/" << offset << " in the next " << count_years << " years: " << filter->count(window) << std::endl;
 
-        for (int x = 0; x < offset; d = d.advance_days(1)) {
-            if (d.weekday() == weekday) {
-                x++;
-            }
-        }
+    auto stats = timefilter::gap_stats(filter, window);
 
-        if (d.month() == month_start.month() && d.year() == month_start.year()) {
-            Datetime dt = Datetime(d);
-            dts.push_back(dt);
-        }
+    if (! stats.has_value()) {
+        return 0;
     }
 
-    std::cout << "Number of " << syntax_vec[0] << "/" << offset << " in the next " << count_years << " years: " << dts.size() << std::endl;
-
-    Duration longest_distance = Duration::zero();
-    Datetime lhs = Datetime::min();
-    Datetime rhs = Datetime::min();
-
-    for (size_t x = 0; dts.size() > 0 && x < dts.size() - 1; x++) {
-        Duration diff = dts[x+1] - dts[x];
-        if (diff > longest_distance) {
-            longest_distance = diff;
-            lhs = dts[x];
-            rhs = dts[x+1];
-        }
-    }
-
-    std::cout << "Longest distance between: " << longest_distance << std::endl;
-    std::cout << lhs << " --> " << rhs << std::endl;
+    std::cout << "Longest distance between: " << stats->max << std::endl;
+    std::cout << stats->longest.start() << " --> " << stats->longest.end() << std::endl;
     return 0;
 }
@@ -0,0 +1,89 @@
+/*
+ * absolute_index.cpp
+ *
+ * Author: Lain Musgrove (lain.proliant@gmail.com)
+ * Date: Sunday October 18, 2026
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include <csignal>
+#include <iostream>
+#include "moonlight/test.h"
+#include "timefilter/list.h"
+
+using namespace timefilter;
+using namespace moonlight;
+using namespace moonlight::test;
+
+int main() {
+    // Every 3rd day of 2025, a few fixed ranges and instants, a year
+    // overlapping all of them and one periodic filter.
+    auto holidays = [](FilterList::Pointer list) {
+        for (int day = 0; day < 365; day += 3) {
+            list->push(DateFilter::create(Date(2025, Month::January, 1).advance_days(day)));
+        }
+
+        list->push(StaticRangeFilter::create(Datetime(2025, Month::March, 3, 12, 0), Duration::of_hours(36)));
+        list->push(StaticRangeFilter::create(Datetime(2024, Month::June, 1), Duration::of_days(400)));
+        list->push(DatetimeFilter::create(Datetime(2025, Month::August, 8, 8, 8)));
+        list->push(YearFilter::create(2026));
+        return list;
+    };
+
+    auto check_same = [](Filter::Pointer list, Filter::Pointer simple, const Datetime& dt) {
+        auto next_rg = list->next_range(dt);
+        auto prev_rg = list->prev_range(dt);
+        ASSERT_EQUAL(next_rg.has_value(), simple->next_range(dt).has_value());
+        ASSERT_EQUAL(prev_rg.has_value(), simple->prev_range(dt).has_value());
+
+        if (next_rg.has_value()) {
+            ASSERT_EQUAL(next_rg->start(), simple->next_range(dt)->start());
+        }
+
+        if (prev_rg.has_value()) {
+            ASSERT_EQUAL(prev_rg->start(), simple->prev_range(dt)->start());
+        }
+    };
+
+    return TestSuite("timefilter absolute_index tests")
+    .test("absolute filters are indexed", [&]() {
+        auto list = holidays(FilterList::create());
+        auto simple = list->simplify();
+        std::cout << "simple type = " << simple->type_name() << std::endl;
+        ASSERT_TRUE(simple->type() == FilterType::AbsoluteIndex);
+        ASSERT_EQUAL(std::static_pointer_cast<const AbsoluteIndexFilter>(simple)->size(), list->size());
+        ASSERT_TRUE(simple->is_absolute());
+
+        for (auto dt = Datetime(2024, Month::May, 1, 7, 30); dt < Datetime(2027, Month::February, 1); dt = dt + Duration::of_hours(13)) {
+            check_same(list, simple, dt);
+        }
+    })
+    .test("relative filters stay in the list", [&]() {
+        auto list = holidays(FilterList::create());
+        list->push(FilterSet::create()
+                   ->add(WeekdayFilter::create(Weekday::Monday))
+                   ->add(TimeFilter::create(Time(9, 0))));
+        auto simple = list->simplify();
+        std::cout << "simple type = " << simple->type_name() << std::endl;
+        ASSERT_TRUE(simple->type() == FilterType::FilterList);
+        ASSERT_EQUAL(std::static_pointer_cast<const FilterList>(simple)->size(), 2);
+
+        for (auto dt = Datetime(2024, Month::May, 1, 7, 30); dt < Datetime(2027, Month::February, 1); dt = dt + Duration::of_hours(13)) {
+            check_same(list, simple, dt);
+        }
+
+        // Nested lists share one index.
+        auto nested = FilterList::create()->push(simple)->push(list)->simplify();
+        ASSERT_TRUE(nested->equals(*simple));
+    })
+    .test("short lists aren't indexed", [&]() {
+        auto list = FilterList::create()
+            ->push(DateFilter::create(Date(2025, Month::December, 25)))
+            ->push(DateFilter::create(Date(2025, Month::January, 1)));
+        auto simple = list->simplify();
+        ASSERT_TRUE(simple->type() == FilterType::FilterList);
+    })
+    .die_on_signal(SIGSEGV)
+    .run();
+}
@@ -0,0 +1,200 @@
+/*
+ * allocation_free.cpp
+ *
+ * Author: Lain Musgrove (lain.proliant@gmail.com)
+ * Date: Sunday October 18, 2026
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include <atomic>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include "moonlight/test.h"
+#include "timefilter/compiler.h"
+#include "timefilter/datetime.h"
+#include "timefilter/exclusion.h"
+#include "timefilter/offset.h"
+#include "timefilter/parser.h"
+#include "timefilter/static_range.h"
+#include "timefilter/weekday_of_month.h"
+
+// Every allocation in this test program is counted, so that the
+// next_range() and prev_range() of each filter type can be held
+// to allocating nothing.
+static std::atomic<int64_t> allocations = 0;
+
+void* operator new(size_t size) {
+    allocations++;
+    void* p = std::malloc(size == 0 ? 1 : size);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void* operator new(size_t size, std::align_val_t align) {
+    allocations++;
+    const size_t alignment = static_cast<size_t>(align);
+    void* p = std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new[](size_t size, std::align_val_t align) {
+    return operator new(size, align);
+}
+
+// Every form of delete is replaced, as each of them frees memory
+// from one of the replacements above.  GCC sees the std::free()
+// calls inlined against our own operator new and warns about a
+// mismatch that isn't one.
+#if defined(__GNUC__) && ! defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, size_t, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+#if defined(__GNUC__) && ! defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+using namespace timefilter;
+using namespace moonlight;
+using namespace moonlight::test;
+
+int main() {
+    Parser parser;
+    Compiler compiler;
+
+    const std::vector<Datetime> pivots = {
+        Datetime(2024, Month::January, 1),
+        Datetime(2024, Month::February, 29, 9, 0),
+        Datetime(2025, Month::July, 4, 13, 30),
+        Datetime(2025, Month::December, 31, 23, 59)
+    };
+
+    // Counts the allocations made by next_range() and prev_range()
+    // around each pivot, once the filter has been used once.
+    auto check = [&](Filter::Pointer filter, const std::vector<Datetime>& dts) {
+        for (const auto& dt : dts) {
+            filter->next_range(dt);
+            filter->prev_range(dt);
+        }
+
+        const int64_t before = allocations;
+        for (const auto& dt : dts) {
+            filter->next_range(dt);
+            filter->prev_range(dt);
+        }
+        const int64_t count = allocations - before;
+
+        std::cout << *filter << ": " << count << " allocations" << std::endl;
+        ASSERT_EQUAL(count, 0);
+    };
+
+    auto check_pivots = [&](Filter::Pointer filter) {
+        check(filter, pivots);
+    };
+
+    auto compile = [&](const std::string& expr) -> Filter::Pointer {
+        return compiler.compile_filter(parser.parse(expr));
+    };
+
+    return TestSuite("timefilter allocation_free tests")
+    .test("leaf filters", [&]() {
+        check_pivots(MonthFilter::create(std::set{Month::March, Month::October}));
+        check_pivots(MonthdayFilter::create(std::set{1, 15, 31, -1}));
+        check_pivots(TimeFilter::create(std::set{Time(9, 0), Time(17, 30)}));
+        check_pivots(WeekdayFilter::create(std::set{Weekday::Monday, Weekday::Friday}));
+        check_pivots(WeekdayMonthdayFilter::create(std::set{Weekday::Friday}, std::set{13, -1}));
+        check_pivots(WeekdayOfMonthFilter::create(Weekday::Thursday, 4));
+        check_pivots(BusinessDayFilter::create(BusinessDayFilter::default_weekdays(), std::set{Date(2025, Month::July, 4)}));
+        check_pivots(BusinessDayFilter::create(BusinessDayFilter::default_weekdays(), std::set<Date>{}, -1));
+        check_pivots(CadenceFilter::create(Duration::of_days(14), Duration::of_days(1)));
+        check_pivots(YearFilter::create(2025));
+        check_pivots(DateFilter::create(Date(2025, Month::March, 14)));
+        check_pivots(DatetimeFilter::create(Datetime(2025, Month::March, 14, 15, 9)));
+        check_pivots(StaticRangeFilter::create(Datetime(2025, Month::March, 14), Duration::of_days(3)));
+    })
+    .test("composite filters", [&]() {
+        auto mon_9am = FilterSet::create()
+            ->add(WeekdayFilter::create(Weekday::Monday))
+            ->add(TimeFilter::create(Time(9, 0)));
+
+        check_pivots(mon_9am);
+        check_pivots(FilterSet::create(mon_9am)->strategy(ScanStrategy::Leapfrog));
+        check_pivots(FilterDuration::create(mon_9am, Duration::of_hours(1)));
+        check_pivots(FilterOffset::create(mon_9am, Duration::of_minutes(-15)));
+        check_pivots(FilterExclusion::create(WeekdayFilter::create(Weekday::Friday),
+                                      HolidaySet::create({ Date(2024, Month::December, 27) })));
+        check_pivots(RelativeRangeFilter::create(TimeFilter::create(Time(9, 0)), TimeFilter::create(Time(17, 0))));
+        check_pivots(FilterList::create()->push(mon_9am)->push(MonthdayFilter::create(1)));
+        check_pivots(FilterSet::create(mon_9am)->strategy(ScanStrategy::Frames));
+        check_pivots(AbsoluteIndexFilter::create({
+            DateFilter::create(Date(2024, Month::December, 25)),
+            DateFilter::create(Date(2025, Month::March, 14)),
+            DatetimeFilter::create(Datetime(2025, Month::July, 4, 12, 0)),
+            YearFilter::create(2026)
+        }));
+    })
+    .test("compiled filters", [&]() {
+        check_pivots(compile("Mon, Wed, Fri 9:00 - 17:00 @ Jan Mar May Jul Sep Nov"));
+        check_pivots(compile("Feb 29 Mon 9:00"));
+        check_pivots(compile("Oct 31 12:00 @ 2025"));
+
+        auto cron = compile("Mon Wed Fri 9:00 17:30");
+        ASSERT_TRUE(std::static_pointer_cast<const FilterSet>(cron)->plan().strategy == ScanStrategy::Cron);
+        check_pivots(cron);
+    })
+    .test("far pivots", [&]() {
+        // Moved by whole periods of the filter before scanning.
+        const std::vector<Datetime> far_pivots = {
+            Datetime(-8000, Month::January, 1),
+            Datetime(9121, Month::October, 30, 13, 0)
+        };
+        check(compile("Feb 29 Mon 9:00"), far_pivots);
+        check(compile("Mon 9:00, Oct 31 12:00"), far_pivots);
+    })
+    .die_on_signal(SIGSEGV)
+    .run();
+}
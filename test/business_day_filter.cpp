@@ -0,0 +1,139 @@
+/*
+ * business_day_filter.cpp
+ *
+ * Author: Lain Musgrove (lain.proliant@gmail.com)
+ * Date: Sunday October 18, 2026
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include <csignal>
+#include <iostream>
+#include "moonlight/test.h"
+#include "timefilter/business_day.h"
+#include "timefilter/set.h"
+
+using namespace timefilter;
+using namespace moonlight;
+using namespace moonlight::test;
+
+int main() {
+    const std::set<Date> holidays = {
+        Date(2024, Month::January, 1),
+        Date(2024, Month::December, 25)
+    };
+
+    return TestSuite("timefilter business_day_filter tests")
+    .test("next_range() and prev_range() skip weekends and holidays", [&]() {
+        Datetime dtA(2023, Month::December, 29, 10, 0);
+        Datetime dtB(2024, Month::January, 1, 12, 0);
+
+        auto filter = BusinessDayFilter::create(BusinessDayFilter::default_weekdays(), holidays);
+
+        auto rangeA = filter->next_range(dtA);
+        ASSERT_TRUE(rangeA.has_value());
+        std::cout << "rangeA = " << *rangeA << std::endl;
+        ASSERT_EQUAL(*rangeA, Range(Datetime(2024, Month::January, 2),
+                                    Datetime(2024, Month::January, 3)));
+
+        auto rangeB = filter->prev_range(dtB);
+        ASSERT_TRUE(rangeB.has_value());
+        std::cout << "rangeB = " << *rangeB << std::endl;
+        ASSERT_EQUAL(*rangeB, Range(Datetime(2023, Month::December, 29),
+                                    Datetime(2023, Month::December, 30)));
+
+        auto rangeC = filter->prev_range(dtA);
+        ASSERT_TRUE(rangeC.has_value());
+        std::cout << "rangeC = " << *rangeC << std::endl;
+        ASSERT_EQUAL(*rangeC, Range(Datetime(2023, Month::December, 29),
+                                    Datetime(2023, Month::December, 30)));
+    })
+    .test("nth and last business day of month", [&]() {
+        Datetime dtA(2023, Month::December, 15);
+        Datetime dtB(2024, Month::December, 15);
+
+        auto first = BusinessDayFilter::create(BusinessDayFilter::default_weekdays(), holidays, 1);
+        auto last = BusinessDayFilter::create(BusinessDayFilter::default_weekdays(), holidays, -1);
+
+        auto rangeA = first->next_range(dtA);
+        ASSERT_TRUE(rangeA.has_value());
+        std::cout << "rangeA = " << *rangeA << std::endl;
+        ASSERT_EQUAL(*rangeA, Range(Datetime(2024, Month::January, 2),
+                                    Datetime(2024, Month::January, 3)));
+
+        auto rangeB = last->next_range(dtB);
+        ASSERT_TRUE(rangeB.has_value());
+        std::cout << "rangeB = " << *rangeB << std::endl;
+        ASSERT_EQUAL(*rangeB, Range(Datetime(2024, Month::December, 31),
+                                    Datetime(2025, Month::January, 1)));
+
+        auto rangeC = last->prev_range(dtB);
+        ASSERT_TRUE(rangeC.has_value());
+        std::cout << "rangeC = " << *rangeC << std::endl;
+        ASSERT_EQUAL(*rangeC, Range(Datetime(2024, Month::November, 29),
+                                    Datetime(2024, Month::November, 30)));
+    })
+    .test("nth business days that never occur", [&]() {
+        auto filter = BusinessDayFilter::create(BusinessDayFilter::default_weekdays(), holidays, 25);
+        ASSERT_FALSE(filter->next_range(Datetime(2024, Month::January, 1)).has_value());
+        ASSERT_FALSE(filter->prev_range(Datetime(2024, Month::January, 1)).has_value());
+    })
+    .test("advance() by business days", [&]() {
+        auto filter = BusinessDayFilter(BusinessDayFilter::default_weekdays(), holidays);
+
+        ASSERT_EQUAL(filter.advance(Date(2024, Month::December, 20), 5), Date(2024, Month::December, 30));
+        ASSERT_EQUAL(filter.advance(Date(2024, Month::January, 3), -2), Date(2023, Month::December, 29));
+        ASSERT_EQUAL(filter.advance(Date(2024, Month::January, 1), 262), Date(2025, Month::January, 2));
+        ASSERT_EQUAL(filter.advance(Date(2024, Month::December, 31), -300), Date(2023, Month::November, 3));
+        ASSERT_EQUAL(filter.business_days_in_month(2024, Month::December), 21);
+    })
+    .test("business day offsets", [&]() {
+        auto calendar = BusinessDayFilter::create(BusinessDayFilter::default_weekdays(), holidays);
+        auto after = BusinessDayOffset::create(MonthdayFilter::create(-1), calendar, 3);
+        auto before = BusinessDayOffset::create(MonthdayFilter::create(-1), calendar, -2);
+        std::cout << "after = " << *after << std::endl;
+        std::cout << "before = " << *before << std::endl;
+
+        auto day = [](int year, Month month, int day) {
+            return Range(Datetime(year, month, day), Datetime(Date(year, month, day).advance_days(1)));
+        };
+
+        // Dec 31st, 2023 is a Sunday, and Jan 1st is a holiday.
+        ASSERT_EQUAL(*after->next_range(Datetime(2024, Month::January, 3)), day(2024, Month::January, 4));
+        ASSERT_EQUAL(*after->next_range(Datetime(2024, Month::January, 4)), day(2024, Month::February, 5));
+        ASSERT_EQUAL(*after->prev_range(Datetime(2024, Month::January, 3)), day(2023, Month::December, 5));
+        ASSERT_EQUAL(*after->prev_range(Datetime(2024, Month::January, 4, 12, 0)), day(2024, Month::January, 4));
+
+        ASSERT_EQUAL(*before->next_range(Datetime(2024, Month::December, 15)), day(2024, Month::December, 27));
+        ASSERT_EQUAL(*before->prev_range(Datetime(2024, Month::December, 15)), day(2024, Month::November, 28));
+
+        ASSERT_EQUAL(*BusinessDayOffset::create(MonthdayFilter::create(-1), BusinessDayFilter::create(BusinessDayFilter::default_weekdays()), 3)->cycle(),
+                     Duration::of_days(DAYS_PER_CYCLE));
+        ASSERT_FALSE(after->cycle().has_value());
+
+        bool thrown = false;
+
+        try {
+            BusinessDayOffset::create(MonthdayFilter::create(-1), BusinessDayFilter::create(BusinessDayFilter::default_weekdays(), holidays, 1), 3);
+        } catch (const Error& e) {
+            thrown = true;
+        }
+
+        ASSERT_TRUE(thrown);
+    })
+    .test("business days combined with time in a set", [&]() {
+        Datetime dt(2024, Month::December, 24, 18, 0);
+
+        auto filter = FilterSet::create()
+            ->add(BusinessDayFilter::create(BusinessDayFilter::default_weekdays(), holidays))
+            ->add(TimeFilter::create(Time(9, 0)));
+
+        auto rangeA = filter->next_range(dt);
+        ASSERT_TRUE(rangeA.has_value());
+        std::cout << "rangeA = " << *rangeA << std::endl;
+        ASSERT_EQUAL(*rangeA, Range(Datetime(2024, Month::December, 26, 9, 0),
+                                    Datetime(2024, Month::December, 26, 9, 1)));
+    })
+    .die_on_signal(SIGSEGV)
+    .run();
+}
@@ -0,0 +1,125 @@
+/*
+ * cadence_filter.cpp
+ *
+ * Author: Lain Musgrove (lain.proliant@gmail.com)
+ * Date: Sunday October 18, 2026
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include <csignal>
+#include <iostream>
+#include "moonlight/test.h"
+#include "timefilter/cadence.h"
+#include "timefilter/set.h"
+
+using namespace timefilter;
+using namespace moonlight;
+using namespace moonlight::test;
+
+int main() {
+    return TestSuite("timefilter cadence_filter tests")
+    .test("next_range() and prev_range() for subday cadence", [&]() {
+        Datetime dtA(2024, Month::February, 12, 10, 7);
+        Datetime dtB(2024, Month::February, 12, 10, 15);
+
+        auto filter = CadenceFilter::create(Duration::of_minutes(15), Duration::of_minutes(1));
+
+        auto rangeA = filter->next_range(dtA);
+        ASSERT_TRUE(rangeA.has_value());
+        std::cout << "rangeA = " << *rangeA << std::endl;
+        ASSERT_EQUAL(*rangeA, Range(Datetime(2024, Month::February, 12, 10, 15),
+                                    Datetime(2024, Month::February, 12, 10, 16)));
+
+        auto rangeB = filter->prev_range(dtA);
+        ASSERT_TRUE(rangeB.has_value());
+        std::cout << "rangeB = " << *rangeB << std::endl;
+        ASSERT_EQUAL(*rangeB, Range(Datetime(2024, Month::February, 12, 10, 0),
+                                    Datetime(2024, Month::February, 12, 10, 1)));
+
+        auto rangeC = filter->next_range(dtB);
+        ASSERT_TRUE(rangeC.has_value());
+        std::cout << "rangeC = " << *rangeC << std::endl;
+        ASSERT_EQUAL(*rangeC, Range(Datetime(2024, Month::February, 12, 10, 30),
+                                    Datetime(2024, Month::February, 12, 10, 31)));
+
+        auto rangeD = filter->prev_range(dtB);
+        ASSERT_TRUE(rangeD.has_value());
+        std::cout << "rangeD = " << *rangeD << std::endl;
+        ASSERT_EQUAL(*rangeD, Range(Datetime(2024, Month::February, 12, 10, 15),
+                                    Datetime(2024, Month::February, 12, 10, 16)));
+    })
+    .test("next_range() and prev_range() for alternate weeks", [&]() {
+        Datetime dt(2024, Month::February, 12);
+
+        auto filter = CadenceFilter::create(Duration::of_days(14), Duration::of_days(7));
+
+        auto rangeA = filter->next_range(dt);
+        ASSERT_TRUE(rangeA.has_value());
+        std::cout << "rangeA = " << *rangeA << std::endl;
+        ASSERT_EQUAL(*rangeA, Range(Datetime(2024, Month::February, 18),
+                                    Datetime(2024, Month::February, 25)));
+
+        auto rangeB = filter->prev_range(dt);
+        ASSERT_TRUE(rangeB.has_value());
+        std::cout << "rangeB = " << *rangeB << std::endl;
+        ASSERT_EQUAL(*rangeB, Range(Datetime(2024, Month::February, 4),
+                                    Datetime(2024, Month::February, 11)));
+    })
+    .test("anchored cadence far from the anchor", [&]() {
+        Datetime anchor(2024, Month::February, 12);
+        Datetime dt(2524, Month::February, 12, 12, 0);
+
+        auto filter = CadenceFilter::create(Duration::of_days(3), Duration::of_days(1), anchor);
+
+        auto rangeA = filter->prev_range(anchor);
+        ASSERT_TRUE(rangeA.has_value());
+        std::cout << "rangeA = " << *rangeA << std::endl;
+        ASSERT_EQUAL(*rangeA, Range(Datetime(2024, Month::February, 12),
+                                    Datetime(2024, Month::February, 13)));
+
+        auto rangeB = filter->next_range(dt);
+        auto rangeC = filter->prev_range(dt);
+        ASSERT_TRUE(rangeB.has_value());
+        ASSERT_TRUE(rangeC.has_value());
+        std::cout << "rangeB = " << *rangeB << std::endl;
+        std::cout << "rangeC = " << *rangeC << std::endl;
+        ASSERT_EQUAL(rangeB->start() - rangeC->start(), Duration::of_days(3));
+        ASSERT_TRUE(rangeC->start() <= dt);
+        ASSERT_TRUE(dt < rangeB->start());
+    })
+    .test("cadence combined with weekday in a set", [&]() {
+        Datetime dt(2024, Month::February, 12);
+
+        auto filter = FilterSet::create()
+            ->add(WeekdayFilter::create(Weekday::Monday))
+            ->add(CadenceFilter::create(Duration::of_days(14), Duration::of_days(7)));
+
+        std::cout << "filter = " << *filter << std::endl;
+
+        auto rangeA = filter->next_range(dt);
+        ASSERT_TRUE(rangeA.has_value());
+        std::cout << "rangeA = " << *rangeA << std::endl;
+        ASSERT_EQUAL(*rangeA, Range(Datetime(2024, Month::February, 19),
+                                    Datetime(2024, Month::February, 20)));
+
+        auto rangeB = filter->prev_range(dt);
+        ASSERT_TRUE(rangeB.has_value());
+        std::cout << "rangeB = " << *rangeB << std::endl;
+        ASSERT_EQUAL(*rangeB, Range(Datetime(2024, Month::February, 5),
+                                    Datetime(2024, Month::February, 6)));
+    })
+    .test("invalid cadences", [&]() {
+        bool thrown = false;
+
+        try {
+            CadenceFilter::create(Duration::of_minutes(1), Duration::of_minutes(2));
+        } catch (const Error& e) {
+            thrown = true;
+        }
+
+        ASSERT_TRUE(thrown);
+    })
+    .die_on_signal(SIGSEGV)
+    .run();
+}
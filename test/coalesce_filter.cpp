@@ -0,0 +1,190 @@
+/*
+ * coalesce_filter.cpp
+ *
+ * Author: Lain Musgrove (lain.proliant@gmail.com)
+ * Date: Sunday October 18, 2026
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include <csignal>
+#include <iostream>
+#include "moonlight/test.h"
+#include "timefilter/absolute_index.h"
+#include "timefilter/business_day.h"
+#include "timefilter/list.h"
+#include "timefilter/set.h"
+#include "timefilter/stream.h"
+
+using namespace timefilter;
+using namespace moonlight;
+using namespace moonlight::test;
+
+int main() {
+    const std::set<Weekday> weekdays = {
+        Weekday::Monday, Weekday::Tuesday, Weekday::Wednesday, Weekday::Thursday, Weekday::Friday
+    };
+
+    return TestSuite("timefilter coalesce_filter tests")
+    .test("coalesced weekdays", [&]() {
+        // Wednesday, 2024-05-15
+        Datetime dt(2024, Month::May, 15, 12, 0);
+        auto filter = WeekdayFilter::create(weekdays);
+
+        auto rangeA = filter->next_coalesced_range(dt);
+        ASSERT_TRUE(rangeA.has_value());
+        std::cout << "rangeA = " << *rangeA << std::endl;
+        ASSERT_EQUAL(*rangeA, Range(Datetime(2024, Month::May, 20), Datetime(2024, Month::May, 25)));
+
+        auto rangeB = filter->prev_coalesced_range(dt);
+        ASSERT_TRUE(rangeB.has_value());
+        std::cout << "rangeB = " << *rangeB << std::endl;
+        ASSERT_EQUAL(*rangeB, Range(Datetime(2024, Month::May, 13), Datetime(2024, Month::May, 18)));
+
+        auto every_day = WeekdayFilter::create(std::set{
+            Weekday::Sunday, Weekday::Monday, Weekday::Tuesday, Weekday::Wednesday,
+            Weekday::Thursday, Weekday::Friday, Weekday::Saturday
+        });
+        // One endless run, which started before any pivot.
+        ASSERT_FALSE(every_day->next_coalesced_range(dt).has_value());
+        auto rangeC = every_day->prev_coalesced_range(dt);
+        ASSERT_TRUE(rangeC.has_value());
+        std::cout << "rangeC = " << *rangeC << std::endl;
+        ASSERT_EQUAL(*rangeC, Range(Datetime::min(), Datetime::max()));
+        ASSERT_EQUAL(every_day->coverage(Range(dt, dt + Duration::of_days(30))), Duration::of_days(30));
+    })
+    .test("coalesced months and monthdays", [&]() {
+        Datetime dt(2024, Month::May, 15, 12, 0);
+        auto months = MonthFilter::create(std::set{Month::January, Month::February, Month::December});
+
+        auto rangeA = months->next_coalesced_range(dt);
+        ASSERT_TRUE(rangeA.has_value());
+        std::cout << "rangeA = " << *rangeA << std::endl;
+        ASSERT_EQUAL(*rangeA, Range(Datetime(2024, Month::December, 1), Datetime(2025, Month::March, 1)));
+
+        auto rangeB = months->prev_coalesced_range(dt);
+        ASSERT_TRUE(rangeB.has_value());
+        std::cout << "rangeB = " << *rangeB << std::endl;
+        ASSERT_EQUAL(*rangeB, Range(Datetime(2023, Month::December, 1), Datetime(2024, Month::March, 1)));
+
+        auto monthdays = MonthdayFilter::create(std::set{-2, -1, 1, 2});
+        auto rangeC = monthdays->next_coalesced_range(dt);
+        ASSERT_TRUE(rangeC.has_value());
+        std::cout << "rangeC = " << *rangeC << std::endl;
+        ASSERT_EQUAL(*rangeC, Range(Datetime(2024, Month::May, 30), Datetime(2024, Month::June, 3)));
+    })
+    .test("coalesced times", [&]() {
+        Datetime dt(2024, Month::May, 15, 12, 0);
+        auto filter = TimeFilter::create(std::set{Time(23, 58), Time(23, 59), Time(0, 0), Time(9, 0)});
+
+        auto rangeA = filter->next_coalesced_range(dt);
+        ASSERT_TRUE(rangeA.has_value());
+        std::cout << "rangeA = " << *rangeA << std::endl;
+        ASSERT_EQUAL(*rangeA, Range(Datetime(2024, Month::May, 15, 23, 58), Datetime(2024, Month::May, 16, 0, 1)));
+
+        auto rangeB = filter->prev_coalesced_range(dt);
+        ASSERT_TRUE(rangeB.has_value());
+        std::cout << "rangeB = " << *rangeB << std::endl;
+        ASSERT_EQUAL(*rangeB, Range(Datetime(2024, Month::May, 15, 9, 0), Datetime(2024, Month::May, 15, 9, 1)));
+    })
+    .test("coalesced lists compare neighboring ranges", [&]() {
+        Datetime dt(2024, Month::May, 15, 12, 0);
+        auto filter = FilterList::create()
+            ->push(WeekdayFilter::create(Weekday::Saturday))
+            ->push(WeekdayFilter::create(Weekday::Sunday));
+
+        auto rangeA = filter->next_coalesced_range(dt);
+        ASSERT_TRUE(rangeA.has_value());
+        std::cout << "rangeA = " << *rangeA << std::endl;
+        ASSERT_EQUAL(*rangeA, Range(Datetime(2024, Month::May, 18), Datetime(2024, Month::May, 20)));
+
+        auto rangeB = filter->prev_coalesced_range(Datetime(2024, Month::May, 19, 12, 0));
+        ASSERT_TRUE(rangeB.has_value());
+        std::cout << "rangeB = " << *rangeB << std::endl;
+        ASSERT_EQUAL(*rangeB, *rangeA);
+    })
+    .test("coalesced runs of thousands of ranges", [&]() {
+        std::set<Time> all_day;
+        for (int minute = 0; minute < 24 * 60; minute++) {
+            all_day.insert(Time(minute / 60, minute % 60));
+        }
+
+        // Every minute of January, 44640 ranges in all.
+        auto january = FilterSet::create()
+            ->add(MonthFilter::create(Month::January))
+            ->add(TimeFilter::create(all_day));
+        const Range run(Datetime(2025, Month::January, 1), Datetime(2025, Month::February, 1));
+
+        auto rangeA = january->next_coalesced_range(Datetime(2024, Month::June, 1));
+        ASSERT_TRUE(rangeA.has_value());
+        std::cout << "rangeA = " << *rangeA << std::endl;
+        ASSERT_EQUAL(*rangeA, run);
+        ASSERT_EQUAL(*january->prev_coalesced_range(Datetime(2025, Month::January, 20, 12, 0)), run);
+        ASSERT_EQUAL(*january->next_coalesced_range(Datetime(2025, Month::January, 20, 12, 0)),
+                     Range(Datetime(2026, Month::January, 1), Datetime(2026, Month::February, 1)));
+
+        // Branches which together cover every day of the week.
+        auto every_day = FilterList::create()
+            ->push(WeekdayFilter::create(std::set{Weekday::Monday, Weekday::Tuesday, Weekday::Wednesday}))
+            ->push(WeekdayFilter::create(std::set{Weekday::Thursday, Weekday::Friday, Weekday::Saturday, Weekday::Sunday}));
+        ASSERT_FALSE(every_day->next_coalesced_range(run.start()).has_value());
+        ASSERT_EQUAL(*every_day->prev_coalesced_range(run.start()), Range(Datetime::min(), Datetime::max()));
+    })
+    .test("coalesced runs of absolute filters", [&]() {
+        // Every day from 1900 through 2399, bridged at the end of 2399 by
+        // a static range into a run of every day of 2400.
+        Filter::Vector filters;
+        for (Date date(1900, Month::January, 1); date < Date(2400, Month::January, 1); date = date.advance_days(1)) {
+            filters.push_back(DateFilter::create(date));
+        }
+        filters.push_back(StaticRangeFilter::create(Range(Datetime(2399, Month::December, 31, 12, 0), Datetime(2400, Month::January, 1, 1, 0))));
+        filters.push_back(YearFilter::create(2400));
+        filters.push_back(DateFilter::create(Date(2500, Month::June, 1)));
+
+        auto index = AbsoluteIndexFilter::create(filters);
+        const Range run(Datetime(1900, Month::January, 1), Datetime(2401, Month::January, 1));
+
+        ASSERT_EQUAL(*index->next_coalesced_range(Datetime(1899, Month::June, 1)), run);
+        ASSERT_EQUAL(*index->prev_coalesced_range(Datetime(2400, Month::June, 1)), run);
+        ASSERT_EQUAL(*index->next_coalesced_range(Datetime(2000, Month::June, 1)),
+                     Range(Datetime(2500, Month::June, 1), Datetime(2500, Month::June, 2)));
+        ASSERT_FALSE(index->next_coalesced_range(Datetime(2500, Month::June, 1)).has_value());
+
+        // Every day but one holiday: the run after it never ends, and
+        // without a cycle it can't be told from a very long one.
+        auto every_day = BusinessDayFilter::create(
+            std::set{Weekday::Monday, Weekday::Tuesday, Weekday::Wednesday, Weekday::Thursday,
+                     Weekday::Friday, Weekday::Saturday, Weekday::Sunday},
+            std::set{Date(2025, Month::January, 1)});
+        bool thrown = false;
+        try {
+            every_day->next_coalesced_range(Datetime(2024, Month::June, 1));
+        } catch (const Error& e) {
+            std::cout << e.what() << std::endl;
+            thrown = true;
+        }
+        ASSERT_TRUE(thrown);
+    })
+    .test("coalesced range streams", [&]() {
+        auto filter = FilterSet::create()
+            ->add(MonthFilter::create(std::set{Month::June, Month::July}))
+            ->add(WeekdayFilter::create(weekdays));
+
+        RangeStream ranges(filter, Datetime(2024, Month::June, 1));
+        RangeStream runs(filter, Datetime(2024, Month::June, 1), true);
+
+        auto rangesA = ranges.take(3);
+        ASSERT_EQUAL(rangesA.size(), 3);
+        ASSERT_EQUAL(rangesA[0], Range(Datetime(2024, Month::June, 3), Datetime(2024, Month::June, 4)));
+
+        auto runsA = runs.take(3);
+        for (const auto& run : runsA) {
+            std::cout << "run = " << run << std::endl;
+        }
+        ASSERT_EQUAL(runsA.size(), 3);
+        ASSERT_EQUAL(runsA[0], Range(Datetime(2024, Month::June, 3), Datetime(2024, Month::June, 8)));
+        ASSERT_EQUAL(runsA[2], Range(Datetime(2024, Month::June, 17), Datetime(2024, Month::June, 22)));
+    })
+    .die_on_signal(SIGSEGV)
+    .run();
+}
@@ -0,0 +1,175 @@
+/*
+ * count_filter.cpp
+ *
+ * Author: Lain Musgrove (lain.proliant@gmail.com)
+ * Date: Sunday October 18, 2026
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include <csignal>
+#include <iostream>
+#include "moonlight/test.h"
+#include "timefilter/business_day.h"
+#include "timefilter/cadence.h"
+#include "timefilter/list.h"
+#include "timefilter/set.h"
+#include "timefilter/weekday_of_month.h"
+
+using namespace timefilter;
+using namespace moonlight;
+using namespace moonlight::test;
+
+// Counts by enumerating ranges, to check the closed-form counts against.
+int64_t enumerate_count(Filter::Pointer filter, const Range& window) {
+    return filter->Filter::count(window);
+}
+
+int main() {
+    const std::vector<Range> windows = {
+        Range(Datetime(2024, Month::January, 1), Datetime(2025, Month::January, 1)),
+        Range(Datetime(2023, Month::March, 14, 15, 30), Datetime(2026, Month::February, 1, 8, 0)),
+        Range(Datetime(1999, Month::December, 31, 23, 59), Datetime(2001, Month::March, 1)),
+        Range(Datetime(2024, Month::February, 29, 9, 0), Datetime(2024, Month::February, 29, 17, 0)),
+        Range(Datetime(2024, Month::June, 1), Datetime(2024, Month::June, 1))
+    };
+
+    auto check = [&](Filter::Pointer filter) {
+        std::cout << "filter = " << *filter << std::endl;
+        for (const auto& window : windows) {
+            std::cout << "    " << window << ": " << filter->count(window) << std::endl;
+            ASSERT_EQUAL(filter->count(window), enumerate_count(filter, window));
+        }
+    };
+
+    return TestSuite("timefilter count_filter tests")
+    .test("count() for weekdays", [&]() {
+        auto filter = WeekdayFilter::create(std::set{Weekday::Monday, Weekday::Wednesday, Weekday::Friday});
+        ASSERT_EQUAL(count(filter, windows[0]), 157);
+        check(filter);
+    })
+    .test("count() for monthdays", [&]() {
+        auto filter = MonthdayFilter::create(std::set{1, 29, 31, -1});
+        // 31 and -1 coincide in long months, as do 29 and -1 in a leap February.
+        ASSERT_EQUAL(count(filter, windows[0]), 12 + 12 + 7 + 4);
+        check(filter);
+        check(MonthdayFilter::create(-29));
+    })
+    .test("count() for months", [&]() {
+        auto filter = MonthFilter::create(std::set{Month::January, Month::July});
+        ASSERT_EQUAL(count(filter, windows[0]), 2);
+        check(filter);
+    })
+    .test("count() for times", [&]() {
+        auto filter = TimeFilter::create(std::set{Time(0, 0), Time(9, 0), Time(17, 30)});
+        ASSERT_EQUAL(count(filter, windows[0]), 366 * 3);
+        check(filter);
+    })
+    .test("count() for weekdays of the month", [&]() {
+        check(WeekdayOfMonthFilter::create(Weekday::Thursday, 4));
+        check(WeekdayOfMonthFilter::create(Weekday::Friday, 5));
+        check(WeekdayOfMonthFilter::create(Weekday::Monday, -1));
+        check(WeekdayOfMonthFilter::create(Weekday::Sunday, -5));
+    })
+    .test("count() for business days", [&]() {
+        auto filter = BusinessDayFilter::create(BusinessDayFilter::default_weekdays());
+        ASSERT_EQUAL(count(filter, windows[0]), 262);
+        check(filter);
+        check(BusinessDayFilter::create(BusinessDayFilter::default_weekdays(), std::set<Date>{}, 3));
+        check(BusinessDayFilter::create(std::set{Weekday::Saturday}, std::set<Date>{}, -5));
+
+        const std::set<Date> holidays = {
+            Date(1999, Month::December, 31), Date(2024, Month::January, 1), Date(2024, Month::July, 4),
+            Date(2024, Month::July, 6), Date(2461, Month::December, 25)
+        };
+        auto holiday_filter = BusinessDayFilter::create(BusinessDayFilter::default_weekdays(), holidays);
+        auto first_filter = BusinessDayFilter::create(BusinessDayFilter::default_weekdays(), holidays, 1);
+        check(holiday_filter);
+        check(first_filter);
+
+        // Several decades, and whole 400-year cycles with holidays in them.
+        for (const auto& window : {
+                Range(Datetime(1987, Month::June, 17, 12, 0), Datetime(2051, Month::February, 3)),
+                Range(Datetime(1850, Month::March, 2), Datetime(2700, Month::October, 9, 8, 0))
+            }) {
+            for (auto f : {filter, holiday_filter, first_filter}) {
+                ASSERT_EQUAL(count(f, window), enumerate_count(f, window));
+            }
+        }
+    })
+    .test("count() for cadences", [&]() {
+        check(CadenceFilter::create(Duration::of_days(14), Duration::of_days(7)));
+        check(CadenceFilter::create(Duration::of_minutes(90), Duration::of_minutes(15)));
+    })
+    .test("count() for sets and lists", [&]() {
+        auto setA = FilterSet::create()
+            ->add(MonthFilter::create(std::set{Month::January, Month::July}))
+            ->add(WeekdayFilter::create(Weekday::Monday))
+            ->add(TimeFilter::create(std::set{Time(9, 0), Time(17, 0)}));
+        auto setB = FilterSet::create()
+            ->add(MonthdayFilter::create(-1))
+            ->add(TimeFilter::create(Time(23, 59)));
+        auto setC = FilterSet::create()
+            ->add(YearFilter::create(2024))
+            ->add(MonthFilter::create(Month::February))
+            ->add(MonthdayFilter::create(std::set{1, 29}));
+
+        check(setA);
+        check(setB);
+        check(setC);
+        ASSERT_EQUAL(count(setB, windows[0]), 12);
+
+        auto list = FilterList::create()->push(setA)->push(setB);
+        ASSERT_EQUAL(count(list, windows[1]), count(setA, windows[1]) + count(setB, windows[1]));
+        check(list);
+    })
+    .test("count() for lists with overlapping branches", [&]() {
+        // Mondays the 1st start both branches, and count once.  2024
+        // has three of them.
+        auto list = FilterList::create()
+            ->push(WeekdayFilter::create(Weekday::Monday))
+            ->push(MonthdayFilter::create(1));
+        ASSERT_EQUAL(count(list, windows[0]), 53 + 12 - 3);
+        check(list);
+
+        auto timed = FilterList::create()
+            ->push(FilterSet::create()
+                   ->add(WeekdayFilter::create(Weekday::Monday))
+                   ->add(TimeFilter::create(std::set{Time(9, 0), Time(17, 0)})))
+            ->push(FilterSet::create()
+                   ->add(MonthdayFilter::create(1))
+                   ->add(TimeFilter::create(Time(9, 0))));
+        check(timed);
+
+        // Many weekly periods of the list.
+        auto weekly = FilterList::create()
+            ->push(FilterSet::create()
+                   ->add(WeekdayFilter::create(Weekday::Monday))
+                   ->add(TimeFilter::create(Time(9, 0))))
+            ->push(FilterSet::create()
+                   ->add(WeekdayFilter::create(std::set{Weekday::Monday, Weekday::Wednesday}))
+                   ->add(TimeFilter::create(std::set{Time(9, 0), Time(12, 0)})));
+        check(weekly);
+
+        const Range decade(Datetime(2020, Month::January, 1, 10, 0), Datetime(2030, Month::June, 1));
+        ASSERT_EQUAL(count(weekly, decade), enumerate_count(weekly, decade));
+
+        // Only the branches sharing 9:00 are stepped; the others are
+        // counted in closed form.
+        auto mixed = FilterList::create()
+            ->push(FilterSet::create()
+                   ->add(WeekdayFilter::create(Weekday::Monday))
+                   ->add(TimeFilter::create(Time(9, 0))))
+            ->push(FilterSet::create()
+                   ->add(MonthdayFilter::create(1))
+                   ->add(TimeFilter::create(Time(9, 0))))
+            ->push(FilterSet::create()
+                   ->add(WeekdayFilter::create(Weekday::Tuesday))
+                   ->add(TimeFilter::create(Time(17, 0))))
+            ->push(BusinessDayFilter::create(BusinessDayFilter::default_weekdays()));
+        check(mixed);
+        ASSERT_EQUAL(count(mixed, decade), enumerate_count(mixed, decade));
+    })
+    .die_on_signal(SIGSEGV)
+    .run();
+}
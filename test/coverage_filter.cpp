@@ -0,0 +1,91 @@
+/*
+ * coverage_filter.cpp
+ *
+ * Author: Lain Musgrove (lain.proliant@gmail.com)
+ * Date: Sunday October 18, 2026
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include <csignal>
+#include <iostream>
+#include "moonlight/test.h"
+#include "timefilter/cadence.h"
+#include "timefilter/duration.h"
+#include "timefilter/list.h"
+#include "timefilter/set.h"
+#include "timefilter/weekday_of_month.h"
+
+using namespace timefilter;
+using namespace moonlight;
+using namespace moonlight::test;
+
+int main() {
+    const std::vector<Range> windows = {
+        Range(Datetime(2024, Month::January, 1), Datetime(2024, Month::April, 1)),
+        Range(Datetime(2023, Month::March, 14, 15, 30), Datetime(2025, Month::February, 1, 8, 0)),
+        Range(Datetime(2024, Month::February, 29, 9, 0, 30), Datetime(2024, Month::February, 29, 17, 0))
+    };
+
+    // Compare against the coverage of coalesced runs.
+    auto check = [&](Filter::Pointer filter) {
+        std::cout << "filter = " << *filter << std::endl;
+        for (const auto& window : windows) {
+            std::cout << "    " << window << ": " << filter->coverage(window) << std::endl;
+            ASSERT_EQUAL(filter->coverage(window), filter->Filter::coverage(window));
+        }
+    };
+
+    return TestSuite("timefilter coverage_filter tests")
+    .test("coverage() for periodic filters", [&]() {
+        auto weekdays = WeekdayFilter::create(std::set{Weekday::Saturday, Weekday::Sunday});
+        ASSERT_EQUAL(coverage(weekdays, windows[0]), Duration::of_days(26));
+        check(weekdays);
+        check(MonthdayFilter::create(std::set{1, 2, -1}));
+        check(MonthFilter::create(std::set{Month::February, Month::March, Month::November}));
+
+        // Months the clocks change in aren't whole days long.
+        const Zone zone = Zone::by_name("America/Los_Angeles");
+        const Range zoned(Datetime(zone, Date(2023, Month::December, 15)), Datetime(zone, Date(2026, Month::January, 10)));
+        for (auto filter : {MonthFilter::create(std::set{Month::March, Month::November}),
+                            MonthFilter::create(std::set{Month::January, Month::March, Month::April, Month::November})}) {
+            ASSERT_EQUAL(filter->coverage(zoned), filter->Filter::coverage(zoned));
+        }
+        check(TimeFilter::create(std::set{Time(9, 0), Time(9, 1), Time(17, 0)}));
+        check(WeekdayOfMonthFilter::create(Weekday::Thursday, -1));
+        check(CadenceFilter::create(Duration::of_days(14), Duration::of_days(3)));
+    })
+    .test("coverage() for durations", [&]() {
+        auto shifts = FilterDuration::create(TimeFilter::create(Time(9, 0)), Duration::of_hours(8));
+        ASSERT_EQUAL(coverage(shifts, windows[0]), Duration::of_hours(8 * 91));
+        check(shifts);
+
+        // Overlapping ranges are only counted once.
+        auto overlapping = FilterDuration::create(TimeFilter::create(std::set{Time(9, 0), Time(12, 0)}), Duration::of_hours(8));
+        ASSERT_EQUAL(coverage(overlapping, windows[0]), Duration::of_hours(11 * 91));
+        check(overlapping);
+
+        auto on_call = FilterDuration::create(WeekdayFilter::create(Weekday::Friday), Duration::of_days(3));
+        ASSERT_TRUE(std::abs(duty_cycle(on_call, windows[0]) - 39.0 / 91.0) < 0.0001);
+        check(on_call);
+    })
+    .test("coverage() for sets and lists", [&]() {
+        auto setA = FilterSet::create()
+            ->add(MonthFilter::create(std::set{Month::February, Month::March}))
+            ->add(WeekdayFilter::create(Weekday::Monday))
+            ->add(TimeFilter::create(std::set{Time(9, 0), Time(17, 0)}));
+        auto setB = FilterSet::create()
+            ->add(MonthFilter::create(Month::March))
+            ->add(WeekdayFilter::create(std::set{Weekday::Monday, Weekday::Tuesday}));
+
+        check(setA);
+        check(setB);
+        ASSERT_EQUAL(coverage(setB, windows[0]), Duration::of_days(8));
+
+        auto list = FilterList::create()->push(setB)->push(WeekdayFilter::create(Weekday::Monday));
+        ASSERT_EQUAL(coverage(list, windows[0]), Duration::of_days(13 + 4));
+        check(list);
+    })
+    .die_on_signal(SIGSEGV)
+    .run();
+}
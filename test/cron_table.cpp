@@ -0,0 +1,112 @@
+/*
+ * cron_table.cpp
+ *
+ * Author: Lain Musgrove (lain.proliant@gmail.com)
+ * Date: Sunday October 18, 2026
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include <csignal>
+#include <iostream>
+#include "moonlight/test.h"
+#include "timefilter/compiler.h"
+#include "timefilter/parser.h"
+#include "timefilter/weekday_of_month.h"
+
+using namespace timefilter;
+using namespace moonlight;
+using namespace moonlight::test;
+
+int main() {
+    Parser parser;
+    Compiler compiler;
+
+    auto compile_set = [&](const std::string& expr) -> FilterSet::Pointer {
+        auto filter = compiler.compile_filter(parser.parse(expr));
+        ASSERT_TRUE(filter->type() == FilterType::FilterSet);
+        return std::static_pointer_cast<FilterSet>(std::const_pointer_cast<Filter>(filter));
+    };
+
+    std::vector<Datetime> pivots = {
+        Datetime(2024, Month::February, 29, 9, 0),
+        Datetime(2024, Month::February, 29, 8, 59, 59),
+        Datetime(2024, Month::December, 31, 23, 59),
+        Datetime(2025, Month::January, 1),
+        Datetime(2025, Month::March, 31, 17, 30)
+    };
+
+    for (int x = 0; x < 400; x++) {
+        pivots.push_back(Datetime(2023, Month::December, 25) + Duration::of_minutes(x * 1321));
+    }
+
+    // Around the days the clocks change, where a wall time can be
+    // skipped or repeated.
+    const Zone zone = Zone::by_name("America/Los_Angeles");
+    for (const auto& date : {Date(2024, Month::March, 10), Date(2024, Month::November, 3)}) {
+        for (int x = 0; x < 48; x++) {
+            pivots.push_back(Datetime(zone, date) + Duration::of_minutes(x * 7));
+        }
+    }
+
+    // The cron table must agree with scanning frames.
+    auto check = [&](FilterSet::Pointer set) {
+        auto frames = FilterSet::create(set)->strategy(ScanStrategy::Frames);
+        std::cout << "set = " << *set << std::endl;
+        ASSERT_TRUE(set->plan().strategy == ScanStrategy::Cron);
+
+        for (const auto& dt : pivots) {
+            auto next_rg = frames->next_range(dt);
+            auto prev_rg = frames->prev_range(dt);
+            ASSERT_EQUAL(next_rg.has_value(), set->next_range(dt).has_value());
+            ASSERT_EQUAL(prev_rg.has_value(), set->prev_range(dt).has_value());
+
+            if (next_rg.has_value()) {
+                ASSERT_EQUAL(*next_rg, *set->next_range(dt));
+            }
+
+            if (prev_rg.has_value()) {
+                ASSERT_EQUAL(*prev_rg, *set->prev_range(dt));
+            }
+        }
+    };
+
+    return TestSuite("timefilter cron_table tests")
+    .test("cron tables agree with frame scans", [&]() {
+        check(compile_set("Mon 9:00"));
+        check(compile_set("Mon Wed Fri 9:00 12:30 17:45"));
+        check(compile_set("Jan Apr Jul Oct 1st 15th 23:59"));
+        check(compile_set("Feb 29 Mon 9:00"));
+        check(compile_set("Fri 13 0:00"));
+        check(compile_set("Oct 31 12:00"));
+        check(compile_set("Sun 1:00 1:30 2:00 2:30 3:00"));
+        check(FilterSet::create()
+              ->add(MonthdayFilter::create(std::set{-1, 31}))
+              ->add(TimeFilter::create(std::set{Time(0, 0), Time(23, 59)})));
+        check(FilterSet::create()
+              ->add(MonthFilter::create(std::set{Month::February, Month::March}))
+              ->add(WeekdayMonthdayFilter::create(std::set{Weekday::Saturday, Weekday::Sunday}, std::set{1, 2, -1, -2}))
+              ->add(TimeFilter::create(Time(6, 15))));
+    })
+    .test("sets cron can't express are scanned", [&]() {
+        auto seconds = FilterSet::create()
+            ->add(WeekdayFilter::create(Weekday::Monday))
+            ->add(TimeFilter::create(Time(9, 0, 30)));
+        ASSERT_FALSE(CronTable::eligible(seconds->filters()));
+        ASSERT_TRUE(seconds->plan().strategy != ScanStrategy::Cron);
+
+        auto last_sunday = FilterSet::create()
+            ->add(WeekdayOfMonthFilter::create(Weekday::Sunday, -1))
+            ->add(TimeFilter::create(Time(2, 0)));
+        ASSERT_FALSE(CronTable::eligible(last_sunday->filters()));
+
+        auto days = compile_set("Jan Mon");
+        ASSERT_TRUE(days->plan().strategy != ScanStrategy::Cron);
+
+        // Explicit strategies are kept.
+        auto leapfrog = compile_set("Mon 9:00")->strategy(ScanStrategy::Leapfrog);
+        ASSERT_TRUE(leapfrog->plan().strategy == ScanStrategy::Leapfrog);
+    })
+    .die_on_signal(SIGSEGV)
+    .run();
+}
@@ -0,0 +1,108 @@
+/*
+ * density.cpp
+ *
+ * Author: Lain Musgrove (lain.proliant@gmail.com)
+ * Date: Sunday October 18, 2026
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include <cmath>
+#include <csignal>
+#include <iostream>
+#include "moonlight/test.h"
+#include "timefilter/business_day.h"
+#include "timefilter/cadence.h"
+#include "timefilter/compiler.h"
+#include "timefilter/parser.h"
+#include "timefilter/weekday_of_month.h"
+
+using namespace timefilter;
+using namespace moonlight;
+using namespace moonlight::test;
+
+int main() {
+    Parser parser;
+    Compiler compiler;
+
+    auto compile = [&](const std::string& expr) -> Filter::Pointer {
+        return compiler.compile_filter(parser.parse(expr));
+    };
+
+    auto near = [](double a, double b, double tolerance) {
+        return std::abs(a - b) <= tolerance * std::max(std::abs(a), std::abs(b));
+    };
+
+    // Compare the closed form against one whole Gregorian cycle.
+    const Range cycle(Datetime(2000, Month::January, 1), Datetime(2400, Month::January, 1));
+    auto check = [&](Filter::Pointer filter, double tolerance = 0.01) {
+        const Density closed = density(filter);
+        const double per_year = count(filter, cycle) / 400.0;
+        const double fraction = duty_cycle(filter, cycle);
+        std::cout << "filter = " << *filter << std::endl;
+        std::cout << "    closed = " << closed.per_year << "/yr, " << closed.fraction << std::endl;
+        std::cout << "    cycle  = " << per_year << "/yr, " << fraction << std::endl;
+        ASSERT_TRUE(closed.per_year > 0);
+        ASSERT_TRUE(near(closed.per_year, per_year, tolerance));
+        ASSERT_TRUE(near(closed.fraction, fraction, tolerance));
+    };
+
+    return TestSuite("timefilter density tests")
+    .test("closed forms for calendar filters", [&]() {
+        auto mondays = density(WeekdayFilter::create(Weekday::Monday));
+        ASSERT_TRUE(near(mondays.per_year, DAYS_PER_YEAR / 7, 1e-9));
+        ASSERT_TRUE(near(mondays.fraction, 1.0 / 7, 1e-9));
+
+        ASSERT_TRUE(near(density(MonthdayFilter::create(31)).per_year, 7, 1e-9));
+        ASSERT_TRUE(near(density(MonthdayFilter::create(29)).per_year, 11.2425, 1e-9));
+        ASSERT_TRUE(near(density(MonthdayFilter::create(std::set{31, -1})).per_year, 12, 1e-9));
+        ASSERT_TRUE(near(density(MonthFilter::create(Month::February)).fraction, 28.2425 / DAYS_PER_YEAR, 1e-9));
+
+        auto times = density(TimeFilter::create(std::set{Time(9, 0), Time(17, 0)}));
+        ASSERT_TRUE(near(times.per_year, 2 * DAYS_PER_YEAR, 1e-9));
+        ASSERT_TRUE(near(times.fraction, 2.0 / 1440, 1e-9));
+
+        check(WeekdayFilter::create(std::set{Weekday::Saturday, Weekday::Sunday}));
+        check(MonthdayFilter::create(std::set{1, 15, -1}));
+        check(MonthFilter::create(std::set{Month::February, Month::October}));
+        check(TimeFilter::create(std::set{Time(9, 0), Time(9, 1), Time(17, 0)}));
+        check(WeekdayMonthdayFilter::create(Weekday::Friday, 13));
+    })
+    .test("closed forms for business days and cadences", [&]() {
+        auto business_days = density(BusinessDayFilter::create(BusinessDayFilter::default_weekdays()));
+        ASSERT_TRUE(near(business_days.per_year, DAYS_PER_YEAR * 5 / 7, 1e-9));
+        ASSERT_TRUE(near(business_days.fraction, 5.0 / 7, 1e-9));
+
+        auto fortnights = density(CadenceFilter::create(Duration::of_days(14), Duration::of_days(7)));
+        ASSERT_TRUE(near(fortnights.per_year, DAYS_PER_YEAR / 14, 1e-9));
+        ASSERT_TRUE(near(fortnights.fraction, 0.5, 1e-9));
+
+        check(BusinessDayFilter::create(BusinessDayFilter::default_weekdays(), std::set<Date>{}, 3));
+        check(BusinessDayFilter::create(std::set{Weekday::Saturday}, std::set<Date>{}, -5));
+        check(BusinessDayFilter::create(BusinessDayFilter::default_weekdays(), std::set{Date(2024, Month::July, 4)}));
+        check(CadenceFilter::create(Duration::of_minutes(90), Duration::of_minutes(15)));
+        check(CadenceFilter::create(Duration::of_days(9), Duration::of_days(1)));
+    })
+    .test("closed forms for sets", [&]() {
+        check(compile("Mon 9:00"));
+        check(compile("Mon Wed Fri 9:00 17:00"));
+        check(compile("Jan Jul 1st 15th"));
+        check(compile("Oct 31 12:00"));
+
+        // Leap days fall on Mondays a little more often than one in seven.
+        check(compile("Feb 29 Mon 9:00"), 0.1);
+    })
+    .test("other filters are sampled", [&]() {
+        auto list = density(compile("Mon 9:00, Fri 17:00"));
+        ASSERT_TRUE(near(list.per_year, 2 * DAYS_PER_YEAR / 7, 0.01));
+
+        auto last_sundays = density(WeekdayOfMonthFilter::create(Weekday::Sunday, -1));
+        ASSERT_TRUE(near(last_sundays.per_year, 12, 0.01));
+
+        // Absolute filters match a bounded number of times.
+        ASSERT_EQUAL(density(YearFilter::create(2025)).per_year, 0.0);
+        ASSERT_EQUAL(density(compile("Mon 9:00 @ 2025")).per_year, 0.0);
+    })
+    .die_on_signal(SIGSEGV)
+    .run();
+}
@@ -0,0 +1,136 @@
+/*
+ * exclusion_filter.cpp
+ *
+ * Author: Lain Musgrove (lain.proliant@gmail.com)
+ * Date: Sunday October 18, 2026
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include <csignal>
+#include <iostream>
+#include "moonlight/test.h"
+#include "timefilter/exclusion.h"
+#include "timefilter/set.h"
+
+using namespace timefilter;
+using namespace moonlight;
+using namespace moonlight::test;
+
+int main() {
+    return TestSuite("timefilter exclusion_filter tests")
+    .test("load holiday set", [&]() {
+        std::istringstream infile(
+            "# Winter break\n"
+            "2024-12-24\n"
+            "2024-12-25  # Christmas\n"
+            "\n"
+            "2024-12-31\n"
+            "2025-01-01\n"
+        );
+
+        auto holidays = HolidaySet::load(infile);
+        ASSERT_EQUAL(holidays.size(), 4);
+        ASSERT_TRUE(holidays.contains(Date(2024, Month::December, 25)));
+        ASSERT_FALSE(holidays.contains(Date(2024, Month::December, 26)));
+        ASSERT_EQUAL(holidays.month_bits(2024, Month::December), (uint32_t(1) << 23) | (uint32_t(1) << 24) | (uint32_t(1) << 30));
+
+        ASSERT_EQUAL(holidays.skip_forward(Date(2024, Month::December, 24)), Date(2024, Month::December, 26));
+        ASSERT_EQUAL(holidays.skip_forward(Date(2024, Month::December, 31)), Date(2025, Month::January, 2));
+        ASSERT_EQUAL(holidays.skip_backward(Date(2025, Month::January, 1)), Date(2024, Month::December, 30));
+        ASSERT_EQUAL(holidays.skip_backward(Date(2024, Month::December, 25)), Date(2024, Month::December, 23));
+        ASSERT_EQUAL(holidays.skip_forward(Date(2024, Month::June, 1)), Date(2024, Month::June, 1));
+        ASSERT_EQUAL(*holidays.next_holiday(Date(2024, Month::December, 26)), Date(2024, Month::December, 31));
+        ASSERT_EQUAL(*holidays.next_holiday(Date(2024, Month::December, 25)), Date(2024, Month::December, 25));
+        ASSERT_EQUAL(*holidays.next_holiday(Date(2023, Month::March, 1)), Date(2024, Month::December, 24));
+        ASSERT_FALSE(holidays.next_holiday(Date(2025, Month::January, 2)).has_value());
+    })
+    .test("invalid holiday files", [&]() {
+        bool thrown = false;
+        std::istringstream infile("2024-12-24\nDecember 25\n");
+
+        try {
+            HolidaySet::load(infile);
+        } catch (const Error& e) {
+            thrown = true;
+        }
+        ASSERT_TRUE(thrown);
+
+        thrown = false;
+        try {
+            HolidaySet::load_file("does-not-exist.txt");
+        } catch (const Error& e) {
+            thrown = true;
+        }
+        ASSERT_TRUE(thrown);
+    })
+    .test("next_range() and prev_range() skip holidays", [&]() {
+        auto holidays = HolidaySet::create({
+            Date(2024, Month::December, 24),
+            Date(2024, Month::December, 25),
+            Date(2024, Month::December, 26)
+        });
+
+        auto filter = FilterExclusion::create(
+            FilterSet::create()
+                ->add(WeekdayFilter::create(std::set{Weekday::Monday, Weekday::Tuesday, Weekday::Wednesday,
+                                                     Weekday::Thursday, Weekday::Friday}))
+                ->add(TimeFilter::create(Time(9, 0))),
+            holidays);
+
+        std::cout << "filter = " << *filter << std::endl;
+
+        auto rangeA = filter->next_range(Datetime(2024, Month::December, 23, 12, 0));
+        ASSERT_TRUE(rangeA.has_value());
+        std::cout << "rangeA = " << *rangeA << std::endl;
+        ASSERT_EQUAL(*rangeA, Range(Datetime(2024, Month::December, 27, 9, 0),
+                                    Datetime(2024, Month::December, 27, 9, 1)));
+
+        auto rangeB = filter->prev_range(Datetime(2024, Month::December, 27, 8, 0));
+        ASSERT_TRUE(rangeB.has_value());
+        std::cout << "rangeB = " << *rangeB << std::endl;
+        ASSERT_EQUAL(*rangeB, Range(Datetime(2024, Month::December, 23, 9, 0),
+                                    Datetime(2024, Month::December, 23, 9, 1)));
+    })
+    .test("holidays are cut out of longer ranges", [&]() {
+        auto holidays = HolidaySet::create({
+            Date(2025, Month::January, 1),
+            Date(2025, Month::January, 15),
+            Date(2025, Month::January, 16)
+        });
+
+        auto filter = FilterExclusion::create(MonthFilter::create(Month::January), holidays);
+        std::cout << "filter = " << *filter << std::endl;
+
+        const Range partA(Datetime(2025, Month::January, 2), Datetime(2025, Month::January, 15));
+        const Range partB(Datetime(2025, Month::January, 17), Datetime(2025, Month::February, 1));
+
+        ASSERT_EQUAL(*filter->next_range(Datetime(2024, Month::December, 15)), partA);
+        ASSERT_EQUAL(*filter->next_range(Datetime(2025, Month::January, 1, 12, 0)), partA);
+        ASSERT_EQUAL(*filter->next_range(Datetime(2025, Month::January, 3)), partB);
+        ASSERT_EQUAL(*filter->next_range(Datetime(2025, Month::January, 20)),
+                     Range(Datetime(2026, Month::January, 1), Datetime(2026, Month::February, 1)));
+
+        ASSERT_EQUAL(*filter->prev_range(Datetime(2025, Month::January, 20)), partB);
+        ASSERT_EQUAL(*filter->prev_range(Datetime(2025, Month::January, 16, 12, 0)), partA);
+        ASSERT_EQUAL(*filter->prev_range(Datetime(2025, Month::January, 1, 12, 0)),
+                     Range(Datetime(2024, Month::January, 1), Datetime(2024, Month::February, 1)));
+
+        // Ranges falling entirely on holidays are dropped.
+        auto days = FilterExclusion::create(MonthdayFilter::create(std::set{1, 15, 16}), holidays);
+        ASSERT_EQUAL(*days->next_range(Datetime(2024, Month::December, 20)),
+                     Range(Datetime(2025, Month::February, 1), Datetime(2025, Month::February, 2)));
+        ASSERT_EQUAL(*days->prev_range(Datetime(2025, Month::January, 31)),
+                     Range(Datetime(2024, Month::December, 16), Datetime(2024, Month::December, 17)));
+    })
+    .test("business days with a holiday set", [&]() {
+        auto holidays = HolidaySet::create({ Date(2024, Month::December, 25) });
+        auto filter = BusinessDayFilter(BusinessDayFilter::default_weekdays(), holidays, -1);
+
+        ASSERT_EQUAL(filter.business_days_in_month(2024, Month::December), 21);
+        ASSERT_FALSE(filter.is_business_day(Date(2024, Month::December, 25)));
+        ASSERT_EQUAL(*filter.nth_of_month(2024, Month::December), Date(2024, Month::December, 31));
+    })
+    .die_on_signal(SIGSEGV)
+    .run();
+}
@@ -0,0 +1,127 @@
+/*
+ * far_pivot.cpp
+ *
+ * Author: Lain Musgrove (lain.proliant@gmail.com)
+ * Date: Sunday October 18, 2026
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include <csignal>
+#include <iostream>
+#include "moonlight/test.h"
+#include "timefilter/compiler.h"
+#include "timefilter/list.h"
+#include "timefilter/parser.h"
+
+using namespace timefilter;
+using namespace moonlight;
+using namespace moonlight::test;
+
+int main() {
+    Parser parser;
+    Compiler compiler;
+
+    auto compile = [&](const std::string& expr) -> Filter::Pointer {
+        return compiler.compile_filter(parser.parse(expr));
+    };
+
+    // Leap days on a Monday, found year by year.
+    auto is_leap_monday = [](int year) {
+        return last_day_of_month(year, Month::February) == 29
+            && Date(year, Month::February, 29).weekday() == Weekday::Monday;
+    };
+
+    return TestSuite("timefilter far_pivot tests")
+    .test("periods of compiled filters", [&]() {
+        ASSERT_EQUAL(*compile("Mon 9:00")->cycle(), Duration::of_days(7));
+        ASSERT_EQUAL(*compile("9:00, 17:30")->cycle(), Duration::of_days(1));
+        ASSERT_EQUAL(*compile("Feb 29 Mon 9:00")->cycle(), Duration::of_days(DAYS_PER_CYCLE));
+        ASSERT_EQUAL(*compile("Fri 13, Mon 9:00")->cycle(), Duration::of_days(DAYS_PER_CYCLE));
+        ASSERT_EQUAL(*BusinessDayFilter::create(BusinessDayFilter::default_weekdays())->cycle(), Duration::of_days(7));
+        ASSERT_FALSE(compile("Mon 9:00 @ 2025")->cycle().has_value());
+
+        // Lists keep their period as branches come and go.
+        auto list = FilterList::create()->push(compile("Mon 9:00"));
+        ASSERT_EQUAL(*list->cycle(), Duration::of_days(7));
+        list->push(compile("9:00, 17:30"));
+        ASSERT_EQUAL(*list->cycle(), Duration::of_days(7));
+        list->push(compile("Mon 9:00 @ 2025"));
+        ASSERT_FALSE(list->cycle().has_value());
+        list->pop();
+        list->push(compile("Oct 31 12:00"));
+        ASSERT_EQUAL(*list->cycle(), Duration::of_days(DAYS_PER_CYCLE));
+        ASSERT_EQUAL(*FilterList::create(list)->cycle(), Duration::of_days(DAYS_PER_CYCLE));
+        list->pop();
+        ASSERT_EQUAL(*list->simplify()->cycle(), Duration::of_days(7));
+    })
+    .test("far pivots match scanning year by year", [&]() {
+        auto filter = compile("Feb 29 Mon 9:00");
+
+        for (int year : {-8000, 3000, 8123, 9500}) {
+            int next_year = year;
+            while (! is_leap_monday(next_year)) {
+                next_year++;
+            }
+            int prev_year = year - 1;
+            while (! is_leap_monday(prev_year)) {
+                prev_year--;
+            }
+
+            const Datetime dt(year, Month::January, 1);
+            auto next_rg = filter->next_range(dt);
+            auto prev_rg = filter->prev_range(dt);
+            std::cout << dt << ": next = " << *next_rg << ", prev = " << *prev_rg << std::endl;
+            ASSERT_EQUAL(*next_rg, Range(Datetime(next_year, Month::February, 29, 9, 0),
+                                         Datetime(next_year, Month::February, 29, 9, 1)));
+            ASSERT_EQUAL(*prev_rg, Range(Datetime(prev_year, Month::February, 29, 9, 0),
+                                         Datetime(prev_year, Month::February, 29, 9, 1)));
+        }
+
+        // 6800 years apart, or 17 whole cycles.
+        auto list = compile("Mon 9:00, Oct 31 12:00");
+        auto near_rg = list->next_range(Datetime(2321, Month::October, 30, 13, 0));
+        auto far_rg = list->next_range(Datetime(9121, Month::October, 30, 13, 0));
+        ASSERT_EQUAL(far_rg->start(), near_rg->start() + Duration::of_days(DAYS_PER_CYCLE * 17));
+    })
+    .test("far pivots keep their zone's daylight saving time", [&]() {
+        // 2424 repeats 2024's calendar, and with it the days on which
+        // Los Angeles springs forward and falls back.
+        const Zone zone = Zone::by_name("America/Los_Angeles");
+        const Duration cycle = Duration::of_days(DAYS_PER_CYCLE);
+
+        for (const auto& expr : {"2:30", "1:30", "Sun 1:30, 2:15"}) {
+            auto filter = compile(expr);
+
+            for (const auto& date : {Date(2024, Month::March, 10), Date(2024, Month::November, 3)}) {
+                auto near_rg = filter->next_range(Datetime(zone, date, Time(0, 59)));
+                auto far_rg = filter->next_range(Datetime(zone, date.advance_days(DAYS_PER_CYCLE), Time(0, 59)));
+
+                for (int x = 0; x < 4; x++) {
+                    std::cout << expr << ": near = " << *near_rg << ", far = " << *far_rg << std::endl;
+                    ASSERT_EQUAL(far_rg->start(), near_rg->start() + cycle);
+                    ASSERT_EQUAL(far_rg->end(), near_rg->end() + cycle);
+                    near_rg = filter->next_range(near_rg->start());
+                    far_rg = filter->next_range(far_rg->start());
+                }
+
+                auto near_prev = filter->prev_range(Datetime(zone, date, Time(3, 0)));
+                auto far_prev = filter->prev_range(Datetime(zone, date.advance_days(DAYS_PER_CYCLE), Time(3, 0)));
+                ASSERT_EQUAL(far_prev->start(), near_prev->start() + cycle);
+            }
+        }
+    })
+    .test("ranges past the end of time are dropped", [&]() {
+        // December 31st, 9999 is a Friday.
+        auto filter = compile("Mon 9:00");
+        const Datetime dt = Datetime::max() - Duration::of_hours(1);
+        ASSERT_FALSE(filter->next_range(dt).has_value());
+        ASSERT_EQUAL(filter->prev_range(dt)->start(), Datetime(9999, Month::December, 27, 9, 0));
+
+        auto new_year = compile("Jan 1st");
+        ASSERT_EQUAL(new_year->prev_range(Datetime::min() + Duration::of_hours(1))->start(), Datetime::min());
+        ASSERT_FALSE(new_year->next_range(Datetime(9999, Month::January, 2)).has_value());
+    })
+    .die_on_signal(SIGSEGV)
+    .run();
+}
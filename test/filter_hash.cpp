@@ -0,0 +1,101 @@
+/*
+ * filter_hash.cpp
+ *
+ * Author: Lain Musgrove (lain.proliant@gmail.com)
+ * Date: Sunday October 18, 2026
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include <csignal>
+#include <iostream>
+#include <unordered_set>
+#include "moonlight/test.h"
+#include "timefilter/duration.h"
+#include "timefilter/list.h"
+#include "timefilter/set.h"
+
+using namespace timefilter;
+using namespace moonlight;
+using namespace moonlight::test;
+
+int main() {
+    auto same = [](Filter::Pointer filterA, Filter::Pointer filterB) {
+        std::cout << filterA->canonical() << " == " << filterB->canonical() << std::endl;
+        ASSERT_TRUE(filterA->equals(*filterB));
+        ASSERT_TRUE(filterB->equals(*filterA));
+        ASSERT_EQUAL(filterA->hash(), filterB->hash());
+        ASSERT_EQUAL(filterA->canonical(), filterB->canonical());
+    };
+
+    auto different = [](Filter::Pointer filterA, Filter::Pointer filterB) {
+        std::cout << filterA->canonical() << " != " << filterB->canonical() << std::endl;
+        ASSERT_FALSE(filterA->equals(*filterB));
+        ASSERT_FALSE(filterB->equals(*filterA));
+        ASSERT_TRUE(filterA->canonical() != filterB->canonical());
+    };
+
+    auto mon_9am = [] {
+        return FilterSet::create()
+            ->add(WeekdayFilter::create(Weekday::Monday))
+            ->add(TimeFilter::create(Time(9, 0)));
+    };
+
+    auto ten_am_oct = [] {
+        return FilterSet::create()
+            ->add(TimeFilter::create(Time(10, 0)))
+            ->add(MonthFilter::create(Month::October));
+    };
+
+    return TestSuite("timefilter filter_hash tests")
+    .test("leaf filters", [&]() {
+        same(WeekdayFilter::create(std::set{Weekday::Monday, Weekday::Tuesday}),
+             WeekdayFilter::create(std::set{Weekday::Tuesday, Weekday::Monday}));
+        different(WeekdayFilter::create(Weekday::Monday),
+                  WeekdayFilter::create(std::set{Weekday::Monday, Weekday::Tuesday}));
+        different(MonthFilter::create(Month::March), MonthdayFilter::create(2));
+        same(TimeFilter::create(Time(9, 30)), TimeFilter::create(Time(9, 30)));
+        different(TimeFilter::create(Time(9, 30)), TimeFilter::create(Time(9, 31)));
+        different(YearFilter::create(2024), YearFilter::create(2025));
+
+        auto holidays = HolidaySet::create({ Date(2024, Month::December, 25) });
+        different(BusinessDayFilter::create(BusinessDayFilter::default_weekdays(), holidays),
+                  BusinessDayFilter::create(BusinessDayFilter::default_weekdays()));
+        same(BusinessDayFilter::create(BusinessDayFilter::default_weekdays(), holidays),
+             BusinessDayFilter::create(BusinessDayFilter::default_weekdays(), std::set{Date(2024, Month::December, 25)}));
+    })
+    .test("sets and lists ignore order", [&]() {
+        auto setA = mon_9am();
+        auto setB = FilterSet::create()
+            ->add(TimeFilter::create(Time(9, 0)))
+            ->add(WeekdayFilter::create(Weekday::Monday));
+
+        ASSERT_TRUE(setA->repr() != setB->repr());
+        same(setA, setB);
+        different(setA, ten_am_oct());
+
+        auto listA = FilterList::create()->push(setA)->push(ten_am_oct());
+        auto listB = FilterList::create()->push(ten_am_oct())->push(setB);
+        same(listA, listB);
+        different(listA, FilterList::create()->push(setA)->push(setB));
+
+        same(FilterDuration::create(setA, Duration::of_hours(1)),
+             FilterDuration::create(setB, Duration::of_hours(1)));
+        different(FilterDuration::create(setA, Duration::of_hours(1)),
+                  FilterDuration::create(setB, Duration::of_hours(2)));
+    })
+    .test("unordered containers", [&]() {
+        std::unordered_set<Filter::Pointer, FilterHash, FilterEqual> filters;
+        filters.insert(mon_9am());
+        filters.insert(ten_am_oct());
+        filters.insert(mon_9am());
+        filters.insert(FilterSet::create()
+                       ->add(TimeFilter::create(Time(9, 0)))
+                       ->add(WeekdayFilter::create(Weekday::Monday)));
+        ASSERT_EQUAL(filters.size(), 2);
+        ASSERT_TRUE(filters.contains(WeekdayFilter::create(Weekday::Monday)) == false);
+        ASSERT_TRUE(filters.contains(ten_am_oct()));
+    })
+    .die_on_signal(SIGSEGV)
+    .run();
+}
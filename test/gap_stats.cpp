@@ -0,0 +1,132 @@
+/*
+ * gap_stats.cpp
+ *
+ * Author: Lain Musgrove (lain.proliant@gmail.com)
+ * Date: Sunday October 18, 2026
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include <csignal>
+#include <iostream>
+#include "moonlight/test.h"
+#include "timefilter/business_day.h"
+#include "timefilter/gap_stats.h"
+#include "timefilter/set.h"
+#include "timefilter/weekday_of_month.h"
+
+using namespace timefilter;
+using namespace moonlight;
+using namespace moonlight::test;
+
+// Gap stats found by walking every range in the window.
+GapStats walk_gaps(Filter::Pointer filter, const Range& window) {
+    GapStats stats;
+    auto first = filter->next_range(window.start() - Duration::of_millis(1));
+    auto last = filter->prev_range(window.end() - Duration::of_millis(1));
+    _scan_gaps(*filter, *first, last->start(), stats);
+    return stats;
+}
+
+int main() {
+    const Range year = Range(Datetime(2024, Month::January, 1), Datetime(2025, Month::January, 1));
+    const Range decade = Range(Datetime(2024, Month::January, 1), Datetime(2034, Month::January, 1));
+
+    return TestSuite("timefilter gap_stats tests")
+    .test("gap_stats() for weekdays", [&]() {
+        auto filter = WeekdayFilter::create(std::set{Weekday::Monday, Weekday::Wednesday, Weekday::Friday});
+        auto stats = gap_stats(filter, year);
+
+        ASSERT_TRUE(stats.has_value());
+        std::cout << "shortest = " << stats->shortest << std::endl;
+        std::cout << "longest = " << stats->longest << std::endl;
+        ASSERT_EQUAL(stats->gaps, 156);
+        ASSERT_EQUAL(stats->min, Duration::of_days(2));
+        ASSERT_EQUAL(stats->max, Duration::of_days(3));
+        ASSERT_EQUAL(stats->shortest, Range(Datetime(2024, Month::January, 1), Datetime(2024, Month::January, 3)));
+        ASSERT_EQUAL(stats->longest, Range(Datetime(2024, Month::January, 5), Datetime(2024, Month::January, 8)));
+        ASSERT_EQUAL(stats->mean, Duration::of_millis(to_millis(Duration::of_days(364)) / 156));
+    })
+    .test("gap_stats() reduced to one period", [&]() {
+        auto filter = FilterSet::create()
+            ->add(WeekdayFilter::create(std::set{Weekday::Monday, Weekday::Thursday}))
+            ->add(TimeFilter::create(std::set{Time(9, 0), Time(17, 30)}));
+        ASSERT_EQUAL(*filter->cycle(), Duration::of_days(7));
+
+        auto stats = gap_stats(filter, decade);
+        auto walked = walk_gaps(filter, decade);
+        ASSERT_TRUE(stats.has_value());
+        ASSERT_EQUAL(stats->min, walked.min);
+        ASSERT_EQUAL(stats->max, walked.max);
+        ASSERT_EQUAL(stats->shortest, walked.shortest);
+        ASSERT_EQUAL(stats->longest, walked.longest);
+        ASSERT_EQUAL(stats->max, Duration::of_days(3) + Duration::of_hours(15) + Duration::of_minutes(30));
+    })
+    .test("gap_stats() for weekdays of the month", [&]() {
+        auto filter = WeekdayOfMonthFilter::create(Weekday::Friday, 5);
+        auto stats = gap_stats(filter, decade);
+        auto walked = walk_gaps(filter, decade);
+
+        ASSERT_TRUE(stats.has_value());
+        std::cout << "longest = " << stats->longest << std::endl;
+        ASSERT_EQUAL(stats->max, walked.max);
+        ASSERT_EQUAL(stats->longest, walked.longest);
+        ASSERT_EQUAL(stats->gaps, filter->count(decade) - 1);
+    })
+    .test("gap_stats() over two Gregorian cycles", [&]() {
+        // Reduced to one cycle once the window spans 800 years.
+        auto filter = MonthdayFilter::create(std::set{29, 31});
+        ASSERT_EQUAL(*filter->cycle(), Duration::of_days(DAYS_PER_CYCLE));
+
+        const Range centuries(Datetime(1600, Month::January, 1), Datetime(2450, Month::January, 1));
+        auto stats = gap_stats(filter, centuries);
+        auto walked = walk_gaps(filter, centuries);
+        ASSERT_TRUE(stats.has_value());
+        ASSERT_EQUAL(stats->min, walked.min);
+        ASSERT_EQUAL(stats->max, walked.max);
+        ASSERT_EQUAL(stats->shortest, walked.shortest);
+        ASSERT_EQUAL(stats->longest, walked.longest);
+    })
+    .test("gap_stats() reduced to 28 years between skipped leap days", [&]() {
+        const Range centuries(Datetime(1890, Month::June, 1), Datetime(2330, Month::January, 1));
+        const std::vector<Filter::Pointer> filters = {
+            WeekdayOfMonthFilter::create(Weekday::Friday, 5),
+            MonthdayFilter::create(std::set{29, 31}),
+            BusinessDayFilter::create(std::set{Weekday::Saturday}, std::set<Date>{}, -5),
+            FilterSet::create()
+                ->add(MonthFilter::create(Month::February))
+                ->add(MonthdayFilter::create(29))
+                ->add(WeekdayFilter::create(Weekday::Monday))
+                ->add(TimeFilter::create(Time(9, 0)))
+        };
+
+        for (const auto& filter : filters) {
+            ASSERT_TRUE(filter->follows_calendar());
+            auto stats = gap_stats(filter, centuries);
+            auto walked = walk_gaps(filter, centuries);
+            ASSERT_TRUE(stats.has_value());
+            std::cout << *filter << ": shortest = " << stats->shortest << ", longest = " << stats->longest << std::endl;
+            ASSERT_EQUAL(stats->gaps, filter->count(centuries) - 1);
+            ASSERT_EQUAL(stats->min, walked.min);
+            ASSERT_EQUAL(stats->max, walked.max);
+            ASSERT_EQUAL(stats->shortest, walked.shortest);
+            ASSERT_EQUAL(stats->longest, walked.longest);
+        }
+
+        // 2096 to 2104 has no leap day between, which the 28 years
+        // from 1905 alone wouldn't show.
+        auto leap_days = FilterSet::create()
+            ->add(MonthFilter::create(Month::February))
+            ->add(MonthdayFilter::create(29));
+        auto stats = gap_stats(leap_days, Range(Datetime(1905, Month::January, 1), Datetime(2330, Month::January, 1)));
+        ASSERT_TRUE(stats.has_value());
+        ASSERT_EQUAL(stats->max, Duration::of_days(8 * 365 + 1));
+        ASSERT_EQUAL(stats->longest, Range(Datetime(2096, Month::February, 29), Datetime(2104, Month::February, 29)));
+    })
+    .test("gap_stats() with fewer than two ranges", [&]() {
+        auto filter = MonthFilter::create(Month::March);
+        ASSERT_FALSE(gap_stats(filter, year).has_value());
+    })
+    .die_on_signal(SIGSEGV)
+    .run();
+}
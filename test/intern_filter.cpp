@@ -0,0 +1,88 @@
+/*
+ * intern_filter.cpp
+ *
+ * Author: Lain Musgrove (lain.proliant@gmail.com)
+ * Date: Sunday October 18, 2026
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include <csignal>
+#include <iostream>
+#include <thread>
+#include "moonlight/test.h"
+#include "timefilter/datetime.h"
+#include "timefilter/set.h"
+#include "timefilter/static_range.h"
+
+using namespace timefilter;
+using namespace moonlight;
+using namespace moonlight::test;
+
+int main() {
+    return TestSuite("timefilter intern_filter tests")
+    .test("identical leaf filters share a node", [&]() {
+        auto filterA = WeekdayFilter::create(std::set{Weekday::Monday, Weekday::Friday});
+        auto filterB = WeekdayFilter::create(std::set{Weekday::Friday, Weekday::Monday});
+        auto filterC = WeekdayFilter::create(Weekday::Monday);
+        ASSERT_TRUE(filterA.get() == filterB.get());
+        ASSERT_TRUE(filterA.get() != filterC.get());
+
+        auto timeA = TimeFilter::create(Time(9, 0));
+        auto timeB = TimeFilter::create(Time(9, 0));
+        ASSERT_TRUE(timeA.get() == timeB.get());
+
+        // The same instant in different zones reads differently.
+        const Datetime utc(2024, Month::May, 13, 9, 0);
+        const Datetime pacific = utc.zone(Zone::by_name("America/Los_Angeles"));
+        ASSERT_TRUE(DatetimeFilter::create(utc).get() == DatetimeFilter::create(utc).get());
+        ASSERT_TRUE(DatetimeFilter::create(utc).get() != DatetimeFilter::create(pacific).get());
+        ASSERT_FALSE(DatetimeFilter::create(utc)->equals(*DatetimeFilter::create(pacific)));
+        ASSERT_TRUE(StaticRangeFilter::create(utc, Duration::of_hours(1)).get()
+                    != StaticRangeFilter::create(pacific, Duration::of_hours(1)).get());
+
+        // Sets are mutable, so they are never shared.
+        auto setA = FilterSet::create()->add(timeA);
+        auto setB = FilterSet::create()->add(timeB);
+        ASSERT_TRUE(setA.get() != setB.get());
+    })
+    .test("unused nodes are released", [&]() {
+        const size_t before = FilterInterner::global().size();
+        {
+            auto filter = YearFilter::create(1999);
+            ASSERT_EQUAL(FilterInterner::global().size(), before + 1);
+        }
+        ASSERT_EQUAL(FilterInterner::global().size(), before);
+
+        std::weak_ptr<const Filter> released = YearFilter::create(1998);
+        ASSERT_TRUE(released.expired());
+
+        for (int year = 1900; year < 2100; year++) {
+            YearFilter::create(year);
+        }
+        ASSERT_EQUAL(FilterInterner::global().size(), before);
+    })
+    .test("interning from many threads", [&]() {
+        const int thread_count = 8;
+        std::vector<Filter::Pointer> filters(thread_count);
+        std::vector<std::thread> threads;
+
+        for (int n = 0; n < thread_count; n++) {
+            threads.emplace_back([&filters, n]() {
+                for (int x = 0; x < 1000; x++) {
+                    filters[n] = MonthdayFilter::create(std::set{1, 15, -1});
+                }
+            });
+        }
+
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        for (const auto& filter : filters) {
+            ASSERT_TRUE(filter.get() == filters.front().get());
+        }
+    })
+    .die_on_signal(SIGSEGV)
+    .run();
+}
@@ -0,0 +1,111 @@
+/*
+ * list_filter.cpp
+ *
+ * Author: Lain Musgrove (lain.proliant@gmail.com)
+ * Date: Sunday October 18, 2026
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include <csignal>
+#include <iostream>
+#include "moonlight/test.h"
+#include "timefilter/compiler.h"
+#include "timefilter/parser.h"
+
+using namespace timefilter;
+using namespace moonlight;
+using namespace moonlight::test;
+
+int main() {
+    Parser parser;
+    Compiler compiler;
+
+    auto compile = [&](const std::string& expr) -> Filter::Pointer {
+        return compiler.compile_filter(parser.parse(expr));
+    };
+
+    const std::vector<Datetime> pivots = {
+        Datetime(2024, Month::January, 1),
+        Datetime(2024, Month::February, 29, 9, 0),
+        Datetime(2025, Month::July, 4, 13, 30)
+    };
+
+    // The simplified filter must produce the same ranges.
+    auto check_same = [&](Filter::Pointer list, Filter::Pointer simple) {
+        for (const auto& dt : pivots) {
+            auto next_rg = list->next_range(dt);
+            auto prev_rg = list->prev_range(dt);
+            ASSERT_EQUAL(next_rg.has_value(), simple->next_range(dt).has_value());
+            ASSERT_EQUAL(prev_rg.has_value(), simple->prev_range(dt).has_value());
+
+            if (next_rg.has_value()) {
+                ASSERT_EQUAL(*next_rg, *simple->next_range(dt));
+            }
+
+            if (prev_rg.has_value()) {
+                ASSERT_EQUAL(*prev_rg, *simple->prev_range(dt));
+            }
+        }
+    };
+
+    return TestSuite("timefilter list_filter tests")
+    .test("sibling filters are merged", [&]() {
+        auto filter = compile("Mon, Tue, Wed");
+        std::cout << "filter = " << *filter << std::endl;
+        ASSERT_TRUE(filter->type() == FilterType::Weekday);
+        ASSERT_EQUAL(std::static_pointer_cast<const WeekdayFilter>(filter)->weekdays().size(), 3);
+
+        auto list = FilterList::create()
+            ->push(MonthFilter::create(Month::March))
+            ->push(TimeFilter::create(Time(9, 0)))
+            ->push(MonthFilter::create(Month::October))
+            ->push(TimeFilter::create(Time(17, 0)));
+        auto simple = list->simplify();
+        std::cout << "simple = " << *simple << std::endl;
+        ASSERT_EQUAL(std::static_pointer_cast<const FilterList>(simple)->size(), 2);
+        check_same(list, simple);
+    })
+    .test("sets differing in one filter are folded", [&]() {
+        auto filter = compile("Mon 9:00, Tue 9:00, Wed 9:00");
+        std::cout << "filter = " << *filter << std::endl;
+        ASSERT_TRUE(filter->type() == FilterType::FilterSet);
+        ASSERT_EQUAL(std::static_pointer_cast<const FilterSet>(filter)->size(), 2);
+
+        auto list = FilterList::create()
+            ->push(FilterSet::create()
+                   ->add(WeekdayFilter::create(Weekday::Monday))
+                   ->add(TimeFilter::create(Time(9, 0))))
+            ->push(FilterSet::create()
+                   ->add(TimeFilter::create(Time(9, 0)))
+                   ->add(WeekdayFilter::create(Weekday::Friday)))
+            ->push(FilterSet::create()
+                   ->add(WeekdayFilter::create(Weekday::Monday))
+                   ->add(TimeFilter::create(Time(17, 0))))
+            ->push(FilterSet::create()
+                   ->add(WeekdayFilter::create(Weekday::Tuesday))
+                   ->add(TimeFilter::create(Time(12, 0))));
+        auto simple = list->simplify();
+        std::cout << "simple = " << *simple << std::endl;
+        ASSERT_EQUAL(std::static_pointer_cast<const FilterList>(simple)->size(), 3);
+        check_same(list, simple);
+    })
+    .test("nested lists and duplicates", [&]() {
+        auto list = FilterList::create()
+            ->push(FilterList::create()
+                   ->push(WeekdayFilter::create(Weekday::Monday))
+                   ->push(YearFilter::create(2025)))
+            ->push(YearFilter::create(2025))
+            ->push(FilterSet::create()->add(WeekdayFilter::create(Weekday::Monday)));
+        auto simple = list->simplify();
+        std::cout << "simple = " << *simple << std::endl;
+        ASSERT_TRUE(simple->type() == FilterType::FilterList);
+        ASSERT_EQUAL(std::static_pointer_cast<const FilterList>(simple)->size(), 2);
+        check_same(list, simple);
+
+        auto filter = compile("Mon, Mon");
+        ASSERT_EQUAL(filter->repr(), WeekdayFilter::create(Weekday::Monday)->repr());
+    })
+    .die_on_signal(SIGSEGV)
+    .run();
+}
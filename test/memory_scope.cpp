@@ -0,0 +1,131 @@
+/*
+ * memory_scope.cpp
+ *
+ * Author: Lain Musgrove (lain.proliant@gmail.com)
+ * Date: Sunday October 18, 2026
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include <csignal>
+#include <iostream>
+#include "moonlight/test.h"
+#include "timefilter/compiler.h"
+#include "timefilter/parser.h"
+
+using namespace timefilter;
+using namespace moonlight;
+using namespace moonlight::test;
+
+// --------------------------------------------------------
+// Counts the allocations made through it.
+// --------------------------------------------------------
+class CountingResource : public std::pmr::memory_resource {
+ public:
+     CountingResource(std::pmr::memory_resource* upstream) : _upstream(upstream) { }
+
+     size_t allocations() const {
+         return _allocations;
+     }
+
+ protected:
+     void* do_allocate(size_t bytes, size_t alignment) override {
+         _allocations++;
+         return _upstream->allocate(bytes, alignment);
+     }
+
+     void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+         _upstream->deallocate(p, bytes, alignment);
+     }
+
+     bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+         return this == &other;
+     }
+
+ private:
+     std::pmr::memory_resource* _upstream;
+     size_t _allocations = 0;
+};
+
+int main() {
+    Parser parser;
+    Compiler compiler;
+
+    const std::string expr = "Mon, Wed 9:00, Oct 31 12:00 @ 2025";
+    const Datetime pivot = Datetime(2025, Month::June, 1);
+
+    return TestSuite("timefilter memory_scope tests")
+    .test("filters are allocated from the scope's resource", [&]() {
+        auto heap_filter = compiler.compile_filter(parser.parse(expr));
+        auto heap_next = heap_filter->next_range(pivot);
+        auto heap_prev = heap_filter->prev_range(pivot);
+
+        std::pmr::monotonic_buffer_resource arena;
+        CountingResource counter(&arena);
+
+        {
+            MemoryScope scope(&counter);
+            auto filter = compiler.compile_filter(parser.parse(expr));
+            std::cout << "filter = " << *filter << std::endl;
+            ASSERT_TRUE(counter.allocations() > 0);
+            ASSERT_EQUAL(filter->repr(), heap_filter->repr());
+            ASSERT_EQUAL(*filter->next_range(pivot), *heap_next);
+            ASSERT_EQUAL(*filter->prev_range(pivot), *heap_prev);
+
+            // Scoped leaf filters aren't shared with the interner.
+            auto weekday = WeekdayFilter::create(Weekday::Monday);
+            ASSERT_TRUE(weekday.get() != WeekdayFilter::create(Weekday::Monday).get());
+        }
+
+        ASSERT_TRUE(MemoryScope::active() == nullptr);
+        auto weekday = WeekdayFilter::create(Weekday::Monday);
+        ASSERT_TRUE(weekday.get() == WeekdayFilter::create(Weekday::Monday).get());
+    })
+    .test("scopes nest", [&]() {
+        std::pmr::monotonic_buffer_resource arenaA, arenaB;
+        CountingResource counterA(&arenaA), counterB(&arenaB);
+
+        MemoryScope scopeA(&counterA);
+        {
+            MemoryScope scopeB(&counterB);
+            FilterSet::create()->add(TimeFilter::create(Time(9, 0)));
+            ASSERT_TRUE(MemoryScope::active() == &counterB);
+        }
+        ASSERT_TRUE(MemoryScope::active() == &counterA);
+        ASSERT_EQUAL(counterA.allocations(), 0);
+        ASSERT_TRUE(counterB.allocations() > 0);
+    })
+    .test("simplifying within a scope uses its resource", [&]() {
+        std::pmr::monotonic_buffer_resource arena;
+        CountingResource counter(&arena);
+        CountingResource default_counter(std::pmr::new_delete_resource());
+        auto default_resource = std::pmr::set_default_resource(&default_counter);
+
+        {
+            MemoryScope scope(&counter);
+            auto list = FilterList::create()
+                ->push(FilterSet::create()->add(Filter::Vector({
+                    WeekdayFilter::create(Weekday::Monday), TimeFilter::create(Time(9, 0))
+                }, MemoryScope::resource())))
+                ->push(FilterSet::create()->add(Filter::Vector({
+                    WeekdayFilter::create(Weekday::Tuesday), TimeFilter::create(Time(9, 0))
+                }, MemoryScope::resource())))
+                ->push(MonthFilter::create(Month::March))
+                ->push(MonthFilter::create(Month::March))
+                ->push(MonthFilter::create(Month::May));
+
+            for (size_t day = 1; day <= ABSOLUTE_INDEX_MIN; day++) {
+                list->push(DateFilter::create(Date(2025, Month::January, static_cast<int>(day))));
+            }
+
+            auto simple = list->simplify();
+            std::cout << "simple = " << *simple << std::endl;
+            ASSERT_EQUAL(std::static_pointer_cast<const FilterList>(simple)->size(), 3);
+        }
+
+        std::pmr::set_default_resource(default_resource);
+        ASSERT_EQUAL(default_counter.allocations(), 0);
+    })
+    .die_on_signal(SIGSEGV)
+    .run();
+}
@@ -0,0 +1,119 @@
+/*
+ * nth_filter.cpp
+ *
+ * Author: Lain Musgrove (lain.proliant@gmail.com)
+ * Date: Sunday October 18, 2026
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include <csignal>
+#include <iostream>
+#include "moonlight/test.h"
+#include "timefilter/cadence.h"
+#include "timefilter/duration.h"
+#include "timefilter/list.h"
+#include "timefilter/set.h"
+#include "timefilter/weekday_of_month.h"
+
+using namespace timefilter;
+using namespace moonlight;
+using namespace moonlight::test;
+
+int main() {
+    const std::vector<Datetime> pivots = {
+        Datetime(2024, Month::January, 1),
+        Datetime(2024, Month::February, 29, 9, 0),
+        Datetime(2023, Month::December, 31, 23, 59, 59)
+    };
+    const std::vector<int64_t> ks = {1, 2, 7, 31, 100, 365};
+
+    // Compare the seeking nth_next() and nth_prev() against stepping.
+    auto check = [&](Filter::Pointer filter) {
+        std::cout << "filter = " << *filter << std::endl;
+        for (const auto& dt : pivots) {
+            for (auto k : ks) {
+                auto next_rg = filter->nth_next(dt, k);
+                auto prev_rg = filter->nth_prev(dt, k);
+                auto step_next_rg = filter->Filter::nth_next(dt, k);
+                auto step_prev_rg = filter->Filter::nth_prev(dt, k);
+                ASSERT_TRUE(next_rg.has_value() && step_next_rg.has_value());
+                ASSERT_TRUE(prev_rg.has_value() && step_prev_rg.has_value());
+                ASSERT_EQUAL(*next_rg, *step_next_rg);
+                ASSERT_EQUAL(*prev_rg, *step_prev_rg);
+            }
+        }
+    };
+
+    return TestSuite("timefilter nth_filter tests")
+    .test("nth_next() and nth_prev() for periodic filters", [&]() {
+        check(WeekdayFilter::create(std::set{Weekday::Tuesday, Weekday::Thursday}));
+        check(MonthdayFilter::create(std::set{15, -1}));
+        check(MonthFilter::create(std::set{Month::March, Month::September}));
+        check(TimeFilter::create(std::set{Time(9, 0), Time(21, 0)}));
+        check(WeekdayOfMonthFilter::create(Weekday::Friday, 5));
+        check(CadenceFilter::create(Duration::of_days(14), Duration::of_days(7)));
+    })
+    .test("nth_next() and nth_prev() for sets", [&]() {
+        auto filter = FilterSet::create()
+            ->add(WeekdayFilter::create(Weekday::Monday))
+            ->add(TimeFilter::create(Time(9, 0)));
+        check(filter);
+        check(FilterDuration::create(filter, Duration::of_hours(1)));
+
+        auto rangeA = filter->nth_next(Datetime(2024, Month::January, 1, 9, 0), 100);
+        ASSERT_TRUE(rangeA.has_value());
+        std::cout << "rangeA = " << *rangeA << std::endl;
+        ASSERT_EQUAL(*rangeA, Range(Datetime(2025, Month::December, 1, 9, 0),
+                                    Datetime(2025, Month::December, 1, 9, 1)));
+    })
+    .test("nth_next() past the last range", [&]() {
+        auto filter = FilterSet::create()
+            ->add(YearFilter::create(2024))
+            ->add(MonthFilter::create(Month::December))
+            ->add(MonthdayFilter::create(25));
+
+        ASSERT_TRUE(filter->nth_next(Datetime(2020, Month::January, 1), 1).has_value());
+        ASSERT_FALSE(filter->nth_next(Datetime(2020, Month::January, 1), 2).has_value());
+        ASSERT_FALSE(filter->nth_prev(Datetime(2030, Month::January, 1), 2).has_value());
+    })
+    .test("ordinal() of the range containing a datetime", [&]() {
+        const Datetime epoch(2024, Month::January, 1);
+        auto hourly = CadenceFilter::create(Duration::of_hours(1), Duration::of_hours(1), epoch);
+
+        ASSERT_EQUAL(*hourly->ordinal(Datetime(2024, Month::January, 11, 9, 30), epoch), 10 * 24 + 9);
+        ASSERT_EQUAL(*hourly->ordinal(Datetime(2023, Month::December, 31, 23, 30), epoch), -1);
+
+        auto daily = TimeFilter::create(Time(9, 0));
+        ASSERT_EQUAL(*daily->ordinal(Datetime(2024, Month::January, 11, 9, 0, 30), epoch), 10);
+        ASSERT_FALSE(daily->ordinal(Datetime(2024, Month::January, 11, 10, 0), epoch).has_value());
+    })
+    .test("ordinal() of lists with overlapping branches", [&]() {
+        const Datetime epoch(2024, Month::January, 1);
+        auto list = FilterList::create()
+            ->push(WeekdayFilter::create(Weekday::Monday))
+            ->push(MonthdayFilter::create(1));
+
+        // Counting the ranges stepped over from the epoch.
+        for (const auto& dt : {Datetime(2024, Month::April, 1, 12, 0), Datetime(2025, Month::September, 1),
+                               Datetime(2023, Month::May, 1, 8, 0)}) {
+            int64_t steps = 0;
+            if (dt < epoch) {
+                for (auto rg = list->prev_range(epoch - Duration::of_millis(1)); rg->end() > dt; rg = list->prev_range(rg->start() - Duration::of_millis(1))) {
+                    steps--;
+                }
+            } else {
+                for (auto rg = list->next_range(epoch - Duration::of_millis(1)); rg->end() <= dt; rg = list->next_range(rg->start())) {
+                    steps++;
+                }
+            }
+            std::cout << dt << ": ordinal = " << *list->ordinal(dt, epoch) << ", steps = " << steps << std::endl;
+            ASSERT_EQUAL(*list->ordinal(dt, epoch), steps);
+            if (steps >= 0) {
+                ASSERT_EQUAL(*list->nth_next(epoch - Duration::of_millis(1), steps + 1), *list->current_range(dt));
+            }
+        }
+    })
+    .die_on_signal(SIGSEGV)
+    .run();
+}
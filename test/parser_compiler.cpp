@@ -7,6 +7,7 @@
  * Distributed under terms of the MIT license.
  */
 
+#include <chrono>
 #include "moonlight/test.h"
 #include "timefilter/parser.h"
 #include "timefilter/compiler.h"
@@ -318,5 +319,148 @@ int main() {
                         Datetime(2021, Month::April, 7, 18, 00)
                     ));
     })
+    .test("set_prev_within_frame", [&]() {
+        filter_test("Mon 9:00 17:00",
+                    Datetime(2024, Month::January, 1, 12, 0),
+                    Range(
+                        Datetime(2024, Month::January, 1, 9, 0),
+                        Datetime(2024, Month::January, 1, 9, 1)
+                    ),
+                    Range(
+                        Datetime(2024, Month::January, 1, 17, 0),
+                        Datetime(2024, Month::January, 1, 17, 1)
+                    ));
+    })
+    .test("set_prev_past_empty_frames", [&]() {
+        filter_test("Feb 29th 9:00",
+                    Datetime(2025, Month::March, 15),
+                    Range(
+                        Datetime(2024, Month::February, 29, 9, 0),
+                        Datetime(2024, Month::February, 29, 9, 1)
+                    ),
+                    Range(
+                        Datetime(2028, Month::February, 29, 9, 0),
+                        Datetime(2028, Month::February, 29, 9, 1)
+                    ));
+    })
+    .test("joined_sets", [&]() {
+        filter_test("Mon 9:00, Tue 9:00",
+                    Datetime(2024, Month::January, 1, 12, 0),
+                    Range(
+                        Datetime(2024, Month::January, 1, 9, 0),
+                        Datetime(2024, Month::January, 1, 9, 1)
+                    ),
+                    Range(
+                        Datetime(2024, Month::January, 2, 9, 0),
+                        Datetime(2024, Month::January, 2, 9, 1)
+                    ));
+    })
+    .test("cadence_subday", [&]() {
+        filter_test("every 15m",
+                    Datetime(2024, Month::February, 12, 10, 7),
+                    Range(
+                        Datetime(2024, Month::February, 12, 10, 0),
+                        Datetime(2024, Month::February, 12, 10, 1)
+                    ),
+                    Range(
+                        Datetime(2024, Month::February, 12, 10, 15),
+                        Datetime(2024, Month::February, 12, 10, 16)
+                    ));
+    })
+    .test("cadence_every_other_week", [&]() {
+        filter_test("Mon every other week",
+                    Datetime(2024, Month::February, 12),
+                    Range(
+                        Datetime(2024, Month::February, 5),
+                        Datetime(2024, Month::February, 6)
+                    ),
+                    Range(
+                        Datetime(2024, Month::February, 19),
+                        Datetime(2024, Month::February, 20)
+                    ));
+    })
+    .test("cadence_anchored", [&]() {
+        filter_test("Mon 9:00 every other week from 2024-02-12",
+                    Datetime(2024, Month::February, 13),
+                    Range(
+                        Datetime(2024, Month::February, 12, 9, 0),
+                        Datetime(2024, Month::February, 12, 9, 1)
+                    ),
+                    Range(
+                        Datetime(2024, Month::February, 26, 9, 0),
+                        Datetime(2024, Month::February, 26, 9, 1)
+                    ));
+    })
+    .test("counts_out_of_range", [&]() {
+        for (auto expr : {"every 99999999999999999999 days", "every 9223372036854775807 weeks", "Mon + 99999999999999999999d"}) {
+            bool thrown = false;
+
+            try {
+                compile(expr);
+            } catch (const CompilerError& e) {
+                tfm::printfln("expr = '%s', error = %s", expr, e.what());
+                thrown = true;
+            }
+
+            ASSERT_TRUE(thrown);
+        }
+    })
+    .test("at joins sets across the list", [&]() {
+        auto check = [&](const std::string& expr, const std::string& expected) {
+            auto filter = compile(expr);
+            tfm::printfln("expr = '%s', filter = %s", expr, *filter);
+            ASSERT_EQUAL(filter->repr(), expected);
+        };
+
+        check("Mon, Tue @ Jan", "{Weekday<MT>,Month<0>}");
+        check("Mon @ Jan, Tue @ 2025", "[{Weekday<M>,Year<2025>},{Month<0>,Weekday<T>,Year<2025>}]");
+        check("Mon 9:00, Tue @ Jan, Wed - Thu @ 2025",
+              "[{Weekday<M>,Time<09:00:00>,Year<2025>},{Weekday<T>,Year<2025>},"
+              "RelativeRange<{Month<0>,Weekday<W>,Year<2025>}, {Weekday<H>}>]");
+    })
+    .test("long expressions compile in linear time", [&]() {
+        static const std::vector<std::string> weekdays = {"Mon", "Tue", "Wed", "Thu", "Fri"};
+        static const std::vector<std::string> months = {"Jan", "Apr", "Jul", "Oct"};
+
+        auto expression = [&](int terms) {
+            std::ostringstream sb;
+
+            for (int x = 0; x < terms; x++) {
+                if (x > 0) {
+                    sb << ", ";
+                }
+                sb << weekdays[x % weekdays.size()] << " " << (x / 60) % 24 << ":" << std::setw(2) << std::setfill('0') << x % 60;
+                if (x % 1000 == 999) {
+                    sb << " @ " << months[(x / 1000) % months.size()];
+                }
+            }
+
+            return sb.str();
+        };
+
+        // The best of a few runs, to keep a busy machine from skewing
+        // the ratio.
+        auto compile_time = [&](int terms) {
+            auto tokens = parser.parse(expression(terms));
+            auto best = std::chrono::steady_clock::duration::max();
+
+            for (int run = 0; run < 3; run++) {
+                auto start = std::chrono::steady_clock::now();
+                auto filter = compiler.compile_filter(tokens);
+                best = std::min(best, std::chrono::steady_clock::now() - start);
+                ASSERT_TRUE(filter->next_range(Datetime(2025, Month::January, 1)).has_value());
+            }
+
+            return std::chrono::duration<double>(best).count();
+        };
+
+        // Four times the terms should take about four times as long,
+        // where quadratic work would take sixteen.
+        const int terms = 5000;
+        const double small = compile_time(terms);
+        const double large = compile_time(terms * 4);
+        tfm::printfln("compiled %d terms in %fs, %d terms in %fs", terms, small, terms * 4, large);
+        ASSERT_TRUE(large < small * 10);
+    })
     .run();
 }
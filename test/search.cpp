@@ -0,0 +1,127 @@
+/*
+ * search.cpp
+ *
+ * Author: Lain Musgrove (lain.proliant@gmail.com)
+ * Date: Sunday October 18, 2026
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include <csignal>
+#include <iostream>
+#include "moonlight/test.h"
+#include "timefilter/duration.h"
+#include "timefilter/search.h"
+#include "timefilter/set.h"
+
+using namespace timefilter;
+using namespace moonlight;
+using namespace moonlight::test;
+
+int main() {
+    const std::set<Weekday> weekdays = {
+        Weekday::Monday, Weekday::Tuesday, Weekday::Wednesday, Weekday::Thursday, Weekday::Friday
+    };
+
+    auto at = [&](const std::set<Weekday>& days, const Time& time, const Duration& duration) {
+        return FilterDuration::create(
+            FilterSet::create()->add(WeekdayFilter::create(days))->add(TimeFilter::create(time)),
+            duration);
+    };
+
+    const std::vector<Filter::Pointer> commitments = {
+        at(weekdays, Time(9, 0), Duration::of_hours(1)),
+        at(weekdays, Time(12, 0), Duration::of_hours(1)),
+        at({Weekday::Tuesday}, Time(14, 0), Duration::of_hours(2))
+    };
+
+    // Tuesday, 2024-05-14
+    const Range tuesday = Range(Datetime(2024, Month::May, 14, 8, 0), Datetime(2024, Month::May, 14, 18, 0));
+
+    return TestSuite("timefilter search tests")
+    .test("free gaps of at least an hour", [&]() {
+        auto gaps = free_gaps(commitments, tuesday, Duration::of_hours(1)).take(10);
+
+        for (const auto& gap : gaps) {
+            std::cout << "gap = " << gap << std::endl;
+        }
+
+        ASSERT_EQUAL(gaps.size(), 4);
+        ASSERT_EQUAL(gaps[0], Range(Datetime(2024, Month::May, 14, 8, 0), Datetime(2024, Month::May, 14, 9, 0)));
+        ASSERT_EQUAL(gaps[1], Range(Datetime(2024, Month::May, 14, 10, 0), Datetime(2024, Month::May, 14, 12, 0)));
+        ASSERT_EQUAL(gaps[2], Range(Datetime(2024, Month::May, 14, 13, 0), Datetime(2024, Month::May, 14, 14, 0)));
+        ASSERT_EQUAL(gaps[3], Range(Datetime(2024, Month::May, 14, 16, 0), Datetime(2024, Month::May, 14, 18, 0)));
+    })
+    .test("free gaps of at least ninety minutes", [&]() {
+        auto gaps = free_gaps(commitments, tuesday, Duration::of_minutes(90)).take(10);
+
+        ASSERT_EQUAL(gaps.size(), 2);
+        ASSERT_EQUAL(gaps[0], Range(Datetime(2024, Month::May, 14, 10, 0), Datetime(2024, Month::May, 14, 12, 0)));
+        ASSERT_EQUAL(gaps[1], Range(Datetime(2024, Month::May, 14, 16, 0), Datetime(2024, Month::May, 14, 18, 0)));
+    })
+    .test("free gaps with overlapping commitments", [&]() {
+        const std::vector<Filter::Pointer> filters = {
+            at(weekdays, Time(9, 0), Duration::of_hours(3)),
+            at(weekdays, Time(10, 0), Duration::of_hours(1)),
+            at(weekdays, Time(7, 0), Duration::of_hours(2))
+        };
+        const Range window = Range(Datetime(2024, Month::May, 14, 7, 30), Datetime(2024, Month::May, 15, 12, 0));
+
+        auto gaps = free_gaps(filters, window, Duration::of_hours(1)).take(10);
+
+        for (const auto& gap : gaps) {
+            std::cout << "gap = " << gap << std::endl;
+        }
+
+        ASSERT_EQUAL(gaps.size(), 1);
+        ASSERT_EQUAL(gaps[0], Range(Datetime(2024, Month::May, 14, 12, 0), Datetime(2024, Month::May, 15, 7, 0)));
+    })
+    .test("first_common() across filters", [&]() {
+        // Monday, 2024-05-13
+        const Datetime from(2024, Month::May, 13);
+        const std::vector<Filter::Pointer> hosts = {
+            at(weekdays, Time(0, 0), Duration::of_hours(6)),
+            at({Weekday::Wednesday, Weekday::Saturday}, Time(2, 0), Duration::of_hours(2)),
+            MonthFilter::create(std::set{Month::May, Month::June})
+        };
+
+        auto rangeA = first_common(hosts, from, Duration::of_hours(1));
+        ASSERT_TRUE(rangeA.has_value());
+        std::cout << "rangeA = " << *rangeA << std::endl;
+        ASSERT_EQUAL(*rangeA, Range(Datetime(2024, Month::May, 15, 2, 0), Datetime(2024, Month::May, 15, 4, 0)));
+
+        auto rangeB = first_common(hosts, Datetime(2024, Month::May, 15, 3, 30), Duration::of_hours(1));
+        ASSERT_TRUE(rangeB.has_value());
+        std::cout << "rangeB = " << *rangeB << std::endl;
+        ASSERT_EQUAL(*rangeB, Range(Datetime(2024, Month::May, 22, 2, 0), Datetime(2024, Month::May, 22, 4, 0)));
+
+        // The weekly hosts repeat, so two weeks without three common
+        // hours means there are none.
+        ASSERT_FALSE(first_common({hosts[0], hosts[1]}, from, Duration::of_hours(3)).has_value());
+
+        // With the months, the hosts repeat every 400 years, which is
+        // more steps than the search takes before giving up.
+        bool thrown = false;
+
+        try {
+            first_common(hosts, from, Duration::of_hours(3));
+        } catch (const Error& e) {
+            thrown = true;
+        }
+
+        ASSERT_TRUE(thrown);
+    })
+    .test("first_common() with coalesced days", [&]() {
+        const std::vector<Filter::Pointer> filters = {
+            WeekdayFilter::create(weekdays),
+            MonthFilter::create(Month::June)
+        };
+
+        auto range = first_common(filters, Datetime(2024, Month::May, 13), Duration::of_days(5));
+        ASSERT_TRUE(range.has_value());
+        std::cout << "range = " << *range << std::endl;
+        ASSERT_EQUAL(*range, Range(Datetime(2024, Month::June, 3), Datetime(2024, Month::June, 8)));
+    })
+    .die_on_signal(SIGSEGV)
+    .run();
+}
@@ -0,0 +1,163 @@
+/*
+ * set_analysis.cpp
+ *
+ * Author: Lain Musgrove (lain.proliant@gmail.com)
+ * Date: Sunday October 18, 2026
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include <csignal>
+#include <iostream>
+#include <thread>
+#include "moonlight/test.h"
+#include "timefilter/business_day.h"
+#include "timefilter/list.h"
+#include "timefilter/set.h"
+#include "timefilter/weekday_of_month.h"
+
+using namespace timefilter;
+using namespace moonlight;
+using namespace moonlight::test;
+
+int main() {
+    const Datetime pivot = Datetime(2024, Month::January, 1);
+
+    return TestSuite("timefilter set_analysis tests")
+    .test("impossible sets never match", [&]() {
+        auto set = FilterSet::create()
+            ->add(YearFilter::create(2023))
+            ->add(MonthFilter::create(Month::February))
+            ->add(WeekdayFilter::create(Weekday::Monday))
+            ->add(MonthdayFilter::create(29))
+            ->add(TimeFilter::create(Time(9, 0)));
+
+        std::cout << "set = " << *set << std::endl;
+        ASSERT_TRUE(set->analysis().known);
+        ASSERT_TRUE(set->never_matches());
+        ASSERT_FALSE(set->max_wait().has_value());
+        ASSERT_FALSE(set->next_range(pivot).has_value());
+        ASSERT_FALSE(set->prev_range(pivot).has_value());
+        ASSERT_FALSE(set->strategy(ScanStrategy::Leapfrog)->next_range(pivot).has_value());
+
+        // April never has 23 weekdays.
+        auto business_set = FilterSet::create()
+            ->add(MonthFilter::create(Month::April))
+            ->add(BusinessDayFilter::create(BusinessDayFilter::default_weekdays(), std::set<Date>{}, 23));
+
+        ASSERT_TRUE(business_set->never_matches());
+        ASSERT_FALSE(business_set->next_range(pivot).has_value());
+
+        auto list = FilterList::create();
+        list->push(set);
+        list->push(business_set);
+        ASSERT_TRUE(list->never_matches());
+    })
+    .test("sparse sets are found with frame scans", [&]() {
+        auto set = FilterSet::create()
+            ->add(MonthFilter::create(Month::February))
+            ->add(MonthdayFilter::create(29))
+            ->add(WeekdayFilter::create(Weekday::Monday))
+            ->add(TimeFilter::create(Time(9, 0)));
+
+        const auto& analysis = set->analysis();
+        std::cout << "max_gap_days = " << analysis.max_gap_days << std::endl;
+        ASSERT_TRUE(analysis.known);
+        ASSERT_TRUE(analysis.satisfiable);
+        ASSERT_FALSE(set->never_matches());
+        // 2072 to 2112 skips over 2100, which isn't a leap year.
+        ASSERT_TRUE(analysis.max_gap_days >= 40 * 365);
+        ASSERT_TRUE(analysis.max_gap_days <= 40 * 366);
+
+        auto rangeA = set->next_range(pivot);
+        ASSERT_TRUE(rangeA.has_value());
+        std::cout << "rangeA = " << *rangeA << std::endl;
+        ASSERT_EQUAL(*rangeA, Range(Datetime(2044, Month::February, 29, 9, 0),
+                                    Datetime(2044, Month::February, 29, 9, 1)));
+
+        auto rangeB = set->prev_range(pivot);
+        ASSERT_TRUE(rangeB.has_value());
+        std::cout << "rangeB = " << *rangeB << std::endl;
+        ASSERT_EQUAL(*rangeB, Range(Datetime(2016, Month::February, 29, 9, 0),
+                                    Datetime(2016, Month::February, 29, 9, 1)));
+
+        auto rangeC = set->next_range(Datetime(2072, Month::March, 1));
+        ASSERT_TRUE(rangeC.has_value());
+        std::cout << "rangeC = " << *rangeC << std::endl;
+        ASSERT_EQUAL(rangeC->start(), Datetime(2112, Month::February, 29, 9, 0));
+
+        // The month frames scanned are bounded by the gap in months,
+        // rather than days, which still crosses it going back.
+        auto rangeD = set->prev_range(Datetime(2112, Month::February, 28));
+        ASSERT_TRUE(rangeD.has_value());
+        std::cout << "rangeD = " << *rangeD << std::endl;
+        ASSERT_EQUAL(rangeD->start(), Datetime(2072, Month::February, 29, 9, 0));
+
+        auto years = FilterSet::create()
+            ->add(YearFilter::create(2072))
+            ->add(MonthFilter::create(Month::February))
+            ->add(MonthdayFilter::create(29))
+            ->add(WeekdayFilter::create(Weekday::Monday));
+
+        ASSERT_TRUE(years->analysis().bounded);
+        auto rangeE = years->next_range(pivot);
+        ASSERT_TRUE(rangeE.has_value());
+        ASSERT_EQUAL(rangeE->start(), Datetime(2072, Month::February, 29));
+    })
+    .test("dense sets have a short bound", [&]() {
+        auto set = FilterSet::create()
+            ->add(WeekdayFilter::create(std::set{Weekday::Monday, Weekday::Friday}))
+            ->add(TimeFilter::create(Time(9, 0)));
+
+        ASSERT_TRUE(set->analysis().known);
+        ASSERT_TRUE(set->max_wait().has_value());
+        ASSERT_TRUE(*set->max_wait() <= Duration::of_days(31));
+
+        auto last_fridays = FilterSet::create()
+            ->add(WeekdayFilter::create(Weekday::Friday))
+            ->add(MonthdayFilter::create(-1));
+
+        auto range = last_fridays->next_range(pivot);
+        ASSERT_TRUE(range.has_value());
+        std::cout << "range = " << *range << std::endl;
+        ASSERT_EQUAL(range->start(), Datetime(2024, Month::May, 31));
+    })
+    .test("sets with cadences aren't analyzed", [&]() {
+        auto set = FilterSet::create()
+            ->add(CadenceFilter::create(Duration::of_days(14), Duration::of_days(7)))
+            ->add(TimeFilter::create(Time(9, 0)));
+
+        ASSERT_FALSE(set->analysis().known);
+        ASSERT_FALSE(set->never_matches());
+    })
+    .test("threads share the analysis of a new set", [&]() {
+        auto set = FilterSet::create()
+            ->add(MonthFilter::create(Month::February))
+            ->add(MonthdayFilter::create(29))
+            ->add(TimeFilter::create(Time(9, 0, 30)));
+        const Range expected(Datetime(2024, Month::February, 29, 9, 0, 30),
+                             Datetime(2024, Month::February, 29, 9, 1, 30));
+
+        std::vector<std::thread> threads;
+        std::vector<std::optional<Range>> ranges(8);
+
+        for (size_t n = 0; n < ranges.size(); n++) {
+            threads.emplace_back([&, n]() {
+                ranges[n] = set->next_range(pivot);
+            });
+        }
+
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        for (const auto& range : ranges) {
+            ASSERT_TRUE(range.has_value());
+            ASSERT_EQUAL(*range, expected);
+        }
+
+        ASSERT_TRUE(set->analysis().known);
+    })
+    .die_on_signal(SIGSEGV)
+    .run();
+}
@@ -0,0 +1,176 @@
+/*
+ * set_filter.cpp
+ *
+ * Author: Lain Musgrove (lain.proliant@gmail.com)
+ * Date: Sunday October 18, 2026
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include <csignal>
+#include <iostream>
+#include "moonlight/test.h"
+#include "timefilter/cadence.h"
+#include "timefilter/date.h"
+#include "timefilter/set.h"
+#include "timefilter/weekday_of_month.h"
+
+using namespace timefilter;
+using namespace moonlight;
+using namespace moonlight::test;
+
+int main() {
+    const std::vector<Datetime> pivots = {
+        Datetime(2024, Month::January, 1),
+        Datetime(2024, Month::February, 29, 9, 0),
+        Datetime(2025, Month::July, 4, 13, 30)
+    };
+
+    // Both strategies must agree on every range.
+    auto check = [&](FilterSet::Pointer set) {
+        auto frames = FilterSet::create(set)->strategy(ScanStrategy::Frames);
+        auto leapfrog = FilterSet::create(set)->strategy(ScanStrategy::Leapfrog);
+        std::cout << "set = " << *set << std::endl;
+
+        for (const auto& dt : pivots) {
+            auto next_rg = frames->next_range(dt);
+            auto prev_rg = frames->prev_range(dt);
+            ASSERT_EQUAL(next_rg.has_value(), leapfrog->next_range(dt).has_value());
+            ASSERT_EQUAL(prev_rg.has_value(), leapfrog->prev_range(dt).has_value());
+
+            if (next_rg.has_value()) {
+                std::cout << "    next = " << *next_rg << std::endl;
+                ASSERT_EQUAL(*next_rg, *leapfrog->next_range(dt));
+            }
+
+            if (prev_rg.has_value()) {
+                std::cout << "    prev = " << *prev_rg << std::endl;
+                ASSERT_EQUAL(*prev_rg, *leapfrog->prev_range(dt));
+            }
+        }
+    };
+
+    return TestSuite("timefilter set_filter tests")
+    .test("leapfrog and frame scans agree", [&]() {
+        check(FilterSet::create()
+              ->add(WeekdayFilter::create(std::set{Weekday::Monday, Weekday::Friday}))
+              ->add(TimeFilter::create(std::set{Time(9, 0), Time(17, 0)})));
+        check(FilterSet::create()
+              ->add(MonthFilter::create(std::set{Month::March, Month::October}))
+              ->add(WeekdayOfMonthFilter::create(Weekday::Sunday, -1))
+              ->add(TimeFilter::create(Time(2, 0))));
+        check(FilterSet::create()
+              ->add(YearFilter::create(2025))
+              ->add(MonthdayFilter::create(std::set{1, 15}))
+              ->add(TimeFilter::create(Time(12, 0))));
+    })
+    .test("leapfrog scan of a sparse set", [&]() {
+        auto set = FilterSet::create()
+            ->add(MonthFilter::create(Month::February))
+            ->add(MonthdayFilter::create(29))
+            ->add(WeekdayFilter::create(Weekday::Monday))
+            ->add(TimeFilter::create(Time(9, 0)))
+            ->strategy(ScanStrategy::Leapfrog);
+
+        auto rangeA = set->next_range(Datetime(2024, Month::January, 1));
+        ASSERT_TRUE(rangeA.has_value());
+        std::cout << "rangeA = " << *rangeA << std::endl;
+        ASSERT_EQUAL(*rangeA, Range(Datetime(2044, Month::February, 29, 9, 0),
+                                    Datetime(2044, Month::February, 29, 9, 1)));
+
+        auto rangeB = set->prev_range(Datetime(2024, Month::January, 1));
+        ASSERT_TRUE(rangeB.has_value());
+        std::cout << "rangeB = " << *rangeB << std::endl;
+        ASSERT_EQUAL(*rangeB, Range(Datetime(2016, Month::February, 29, 9, 0),
+                                    Datetime(2016, Month::February, 29, 9, 1)));
+    })
+    .test("leapfrog scans give up at the step limit", [&]() {
+        // A cadence a few seconds longer than a day drifts past
+        // midnight, meeting it once in decades and taking about a step
+        // a day to get there.
+        auto drifting = [](int seconds) {
+            return FilterSet::create()
+                ->add(CadenceFilter::create(Duration::of_days(1) + Duration::of_seconds(seconds), Duration::of_minutes(1)))
+                ->add(TimeFilter::create(Time(0, 0)))
+                ->strategy(ScanStrategy::Leapfrog);
+        };
+
+        // Just within the limit, at 9081 steps.
+        auto rangeA = drifting(3)->next_range(Datetime(2024, Month::January, 1));
+        ASSERT_TRUE(rangeA.has_value());
+        std::cout << "rangeA = " << *rangeA << std::endl;
+        ASSERT_EQUAL(rangeA->start(), Datetime(2048, Month::November, 11));
+
+        // Past it, which is an error rather than no range at all.
+        auto past_limit = [](std::function<void()> scan) {
+            try {
+                scan();
+            } catch (const Error& e) {
+                return true;
+            }
+            return false;
+        };
+
+        ASSERT_TRUE(past_limit([&]() { drifting(5)->next_range(Datetime(2024, Month::January, 1)); }));
+        ASSERT_TRUE(past_limit([&]() { drifting(3)->prev_range(Datetime(2024, Month::January, 1)); }));
+    })
+    .test("planner drives sparse sets from the rarest frame", [&]() {
+        // Times off the minute keep the set from using a cron table.
+        auto sparse = FilterSet::create()
+            ->add(MonthFilter::create(Month::February))
+            ->add(MonthdayFilter::create(29))
+            ->add(WeekdayFilter::create(Weekday::Monday))
+            ->add(TimeFilter::create(Time(9, 0, 30)));
+        std::cout << "sparse = " << *sparse << std::endl;
+        ASSERT_TRUE(sparse->strategy() == ScanStrategy::Auto);
+        ASSERT_TRUE(sparse->plan().strategy == ScanStrategy::Leapfrog);
+        ASSERT_EQUAL(sparse->plan().frames, 2);
+        ASSERT_EQUAL(sparse->repr(), "{Month<1>,WeekdayMonthday<M,29>,Time<09:00:30>;leapfrog:WeekdayMonthday,Month}");
+        check(sparse);
+
+        auto dense = FilterSet::create()
+            ->add(WeekdayFilter::create(Weekday::Monday))
+            ->add(TimeFilter::create(Time(9, 0, 30)));
+        ASSERT_TRUE(dense->plan().strategy == ScanStrategy::Frames);
+        ASSERT_EQUAL(dense->repr(), "{Weekday<M>,Time<09:00:30>}");
+
+        // An explicit strategy is kept, checking frames rarest first.
+        auto forced = FilterSet::create(dense)->strategy(ScanStrategy::Leapfrog);
+        ASSERT_TRUE(forced->plan().strategy == ScanStrategy::Leapfrog);
+        ASSERT_EQUAL(forced->repr(), "{Weekday<M>,Time<09:00:30>;leapfrog:Weekday}");
+        ASSERT_TRUE(FilterSet::create(sparse)->strategy(ScanStrategy::Frames)->plan().strategy == ScanStrategy::Frames);
+    })
+    .test("fully determined sets fold into dates", [&]() {
+        auto set = FilterSet::create()
+            ->add(YearFilter::create(2025))
+            ->add(MonthFilter::create(Month::March))
+            ->add(MonthdayFilter::create(3));
+
+        auto simple = set->simplify();
+        std::cout << "simple = " << *simple << std::endl;
+        ASSERT_TRUE(simple->type() == FilterType::Date);
+        ASSERT_EQUAL(std::static_pointer_cast<const DateFilter>(simple)->date(), Date(2025, Month::March, 3));
+
+        auto timed_set = FilterSet::create()
+            ->add(YearFilter::create(2025))
+            ->add(MonthFilter::create(Month::March))
+            ->add(WeekdayOfMonthFilter::create(Weekday::Monday, 1))
+            ->add(TimeFilter::create(Time(9, 0)));
+
+        auto timed_simple = timed_set->simplify();
+        std::cout << "timed_simple = " << *timed_simple << std::endl;
+        ASSERT_TRUE(timed_simple->type() == FilterType::FilterSet);
+        ASSERT_EQUAL(std::static_pointer_cast<const FilterSet>(timed_simple)->size(), 2);
+        ASSERT_EQUAL(*timed_simple->next_range(pivots[0]), *timed_set->next_range(pivots[0]));
+        ASSERT_EQUAL(timed_simple->next_range(pivots[0])->start(), Datetime(2025, Month::March, 3, 9, 0));
+        ASSERT_EQUAL(*timed_simple->prev_range(pivots[2]), *timed_set->prev_range(pivots[2]));
+
+        auto open_set = FilterSet::create()
+            ->add(YearFilter::create(2025))
+            ->add(MonthFilter::create(Month::March))
+            ->add(MonthdayFilter::create(std::set{1, 15}));
+        ASSERT_TRUE(open_set->simplify()->type() == FilterType::FilterSet);
+    })
+    .die_on_signal(SIGSEGV)
+    .run();
+}
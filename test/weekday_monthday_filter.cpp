@@ -0,0 +1,62 @@
+/*
+ * weekday_monthday_filter.cpp
+ *
+ * Author: Lain Musgrove (lain.proliant@gmail.com)
+ * Date: Sunday October 18, 2026
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include <csignal>
+#include <iostream>
+#include "moonlight/test.h"
+#include "timefilter/weekday_monthday.h"
+
+using namespace timefilter;
+using namespace moonlight;
+using namespace moonlight::test;
+
+int main() {
+    return TestSuite("timefilter weekday_monthday_filter tests")
+    .test("next_range() and prev_range() for a monthday", [&]() {
+        auto filter = WeekdayMonthdayFilter::create(Weekday::Friday, 13);
+        Datetime dt(2024, Month::January, 1);
+
+        auto rangeA = filter->next_range(dt);
+        ASSERT_TRUE(rangeA.has_value());
+        std::cout << "rangeA = " << *rangeA << std::endl;
+        ASSERT_EQUAL(*rangeA, Range(Datetime(2024, Month::September, 13),
+                                    Datetime(2024, Month::September, 14)));
+
+        auto rangeB = filter->prev_range(dt);
+        ASSERT_TRUE(rangeB.has_value());
+        std::cout << "rangeB = " << *rangeB << std::endl;
+        ASSERT_EQUAL(*rangeB, Range(Datetime(2023, Month::October, 13),
+                                    Datetime(2023, Month::October, 14)));
+    })
+    .test("negative monthdays count from the end of the month", [&]() {
+        Datetime dt(2024, Month::January, 1);
+
+        auto last_friday = WeekdayMonthdayFilter::create(Weekday::Friday, -1);
+        auto rangeA = last_friday->next_range(dt);
+        ASSERT_TRUE(rangeA.has_value());
+        std::cout << "rangeA = " << *rangeA << std::endl;
+        ASSERT_EQUAL(*rangeA, Range(Datetime(2024, Month::May, 31),
+                                    Datetime(2024, Month::June, 1)));
+
+        auto rangeB = last_friday->prev_range(dt);
+        ASSERT_TRUE(rangeB.has_value());
+        std::cout << "rangeB = " << *rangeB << std::endl;
+        ASSERT_EQUAL(*rangeB, Range(Datetime(2023, Month::June, 30),
+                                    Datetime(2023, Month::July, 1)));
+
+        auto next_to_last = WeekdayMonthdayFilter::create(Weekday::Friday, -2);
+        auto rangeC = next_to_last->next_range(dt);
+        ASSERT_TRUE(rangeC.has_value());
+        std::cout << "rangeC = " << *rangeC << std::endl;
+        ASSERT_EQUAL(*rangeC, Range(Datetime(2024, Month::August, 30),
+                                    Datetime(2024, Month::August, 31)));
+    })
+    .die_on_signal(SIGSEGV)
+    .run();
+}